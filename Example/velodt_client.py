@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+################################################################################
+#                     Copyright (C) 2020 by Christian Meeßen                   #
+#                                                                              #
+#                          This file is part of VeloDT.                        #
+#                                                                              #
+#         VeloDT is free software: you can redistribute it and/or modify       #
+#     it under the terms of the GNU General Public License as published by     #
+#           the Free Software Foundation version 3 of the License.             #
+#                                                                              #
+#        VeloDT is distributed in the hope that it will be useful, but         #
+#          WITHOUT ANY WARRANTY; without even the implied warranty of          #
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       #
+#                   General Public License for more details.                   #
+#                                                                              #
+#      You should have received a copy of the GNU General Public License       #
+#        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        #
+################################################################################
+"""
+Client for 'velodt serve', see 'velodt serve -h' for the protocol.
+
+    from velodt_client import Client
+    with Client('/tmp/velodt.sock') as c:
+        T, rho = c.v2rhot(z, V, params=[1])    # PREM, other settings default
+
+Run as a script it compares the latency of the server with starting V2RhoT
+for every conversion:
+
+    python3 velodt_client.py bench [velodt] [V2RhoT] [requests]
+"""
+import array
+import os
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+OP_PING, OP_V2T, OP_T2RHO, OP_V2RHOT = 0, 1, 2, 3
+STATUS = ['ok', 'invalid argument', 'composition sum must equal 1.0',
+          'iteration did not converge']
+
+
+class Client:
+    def __init__(self, path='/tmp/velodt.sock'):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.connect(path)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def close(self):
+        self.sock.close()
+
+    def _receive(self, size):
+        buf = bytearray()
+        while len(buf) < size:
+            part = self.sock.recv(size - len(buf))
+            if not part:
+                raise ConnectionError('velodt serve closed the connection')
+            buf += part
+        return bytes(buf)
+
+    def request(self, op, z=(), values=(), params=()):
+        """Returns the status and the list of output columns."""
+        n = len(z)
+        if len(values) != n:
+            raise ValueError('z and values differ in length')
+        msg = struct.pack('=iiq', op, len(params), n)
+        msg += array.array('d', params).tobytes()
+        msg += array.array('d', z).tobytes()
+        msg += array.array('d', values).tobytes()
+        self.sock.sendall(msg)
+        status, n_out, n = struct.unpack('=iiq', self._receive(16))
+        out = array.array('d')
+        out.frombytes(self._receive(8*n_out*n))
+        return status, [out[i*n:(i+1)*n] for i in range(n_out)]
+
+    def _convert(self, op, z, values, params):
+        status, out = self.request(op, z, values, params)
+        if status not in (0, 3):
+            raise ValueError(STATUS[status] if status < len(STATUS)
+                             else 'status %d' % status)
+        return out
+
+    def ping(self):
+        return self.request(OP_PING)[0] == 0
+
+    def v2t(self, z, Vs, params=()):
+        """T / degC from Vs / km/s at z / m, NaN where not converged."""
+        return self._convert(OP_V2T, z, Vs, params)[0]
+
+    def t2rho(self, z, T, params=()):
+        """rho / kg/m3 from T / degC at z / m."""
+        return self._convert(OP_T2RHO, z, T, params)[0]
+
+    def v2rhot(self, z, V, params=()):
+        """T / degC and rho / kg/m3 from V / m/s at z / m."""
+        return self._convert(OP_V2RHOT, z, V, params)
+
+
+def bench(velodt, v2rhot, requests):
+    """Mean time per conversion of the PREM Vs profile."""
+    here = os.path.dirname(os.path.abspath(__file__))
+    profile = [l.split() for l in open(os.path.join(here, 'PREM.dat'))
+               if not l.startswith('#')]
+    z = [-1000*float(p[2]) for p in profile]
+    V = [1000*float(p[4]) for p in profile]
+
+    tmp = tempfile.mkdtemp()
+    sock = os.path.join(tmp, 'velodt.sock')
+    server = subprocess.Popen([velodt, 'serve', '-socket', sock],
+                              stdout=subprocess.DEVNULL)
+    try:
+        while not os.path.exists(sock):
+            time.sleep(0.01)
+        with Client(sock) as c:
+            c.v2rhot(z, V, params=[1])
+            start = time.perf_counter()
+            for i in range(requests):
+                c.v2rhot(z, V, params=[1])
+            served = (time.perf_counter() - start)/requests
+    finally:
+        server.terminate()
+        server.wait()
+
+    infile = os.path.join(tmp, 'Vs.dat')
+    with open(infile, 'w') as f:
+        for p in profile:
+            f.write('%s %s %s %s\n' % (p[0], p[1], p[2], p[4]))
+    runs = max(1, min(requests, 50))
+    start = time.perf_counter()
+    for i in range(runs):
+        subprocess.run([v2rhot, infile, os.path.join(tmp, 'out.dat'),
+                        '-type', 'S', '-ERM', 'PREM', '-scaleZ', '-1000',
+                        '-scaleV', '1000'],
+                       stdout=subprocess.DEVNULL, check=True)
+    spawned = (time.perf_counter() - start)/runs
+
+    print('%d points per conversion' % len(z))
+    print('velodt serve: %8.3f ms (%d requests)' % (1000*served, requests))
+    print('V2RhoT      : %8.3f ms (%d runs)' % (1000*spawned, runs))
+    print('Speed-up    : %8.1f' % (spawned/served))
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2 or sys.argv[1] != 'bench':
+        print(__doc__)
+        sys.exit(0)
+    bench(sys.argv[2] if len(sys.argv) > 2 else '../bin/velodt',
+          sys.argv[3] if len(sys.argv) > 3 else '../bin/V2RhoT',
+          int(sys.argv[4]) if len(sys.argv) > 4 else 1000)
@@ -1,6 +1,8 @@
 TEMPLATE = subdirs
 CONFIG -= app_bundle
 CONFIG += ordered
-SUBDIRS += src/common src/V2RhoT src/V2T src/T2Rho
+SUBDIRS += src/common src/V2RhoT src/V2T src/T2Rho src/velodt src/libvelodt
 V2RhoT.depends = common
 V2T.depends = common
+velodt.depends = common
+libvelodt.depends = common
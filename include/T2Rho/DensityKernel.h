@@ -0,0 +1,45 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#ifndef DENSITYKERNEL_H_
+#define DENSITYKERNEL_H_
+
+#include "MineralDB.h"
+
+class DensityKernel {
+/**
+Density of a mantle rock from pressure and temperature after Goes et al.
+(2000). prepare() combines the mineral constants with the composition once,
+densities() then only reads them, so one kernel is used by several threads at
+once. T2Rho and libvelodt share it.
+**/
+  int k_n;                // Number of phases present in the rock
+  double k_rho0;          // Density at T0 and P0
+  double k_rhoAlpha[4];   // Thermal expansion terms alpha0 to alpha3
+  double k_rho[5];        // Fraction times density of each phase
+  double k_K[5];          // Bulk modulus of each phase
+  double k_dKdT[5];       // dK/dT of each phase
+  double k_dKdP[5];       // dK/dP of each phase at the iron content
+
+ public:
+  DensityKernel();
+  void prepare(const MineralSet &DB, const double comp[5], double XFe,
+               bool AlphaT);
+  void densities(int n, const double *P, const double *T, double *rho) const;
+};
+
+#endif  // DENSITYKERNEL_H_
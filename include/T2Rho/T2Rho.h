@@ -19,40 +19,52 @@
 #define T2RHO_H_
 
 #include <QList>
+#include <QVector>
 #include <QString>
 #include <QStringList>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QRegExp>
 #include <math.h>
 #include <iostream>
 #include <stdlib.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "DataFile.h"
 #include "PhysicalConstants.h"
 #include "PointClasses.h"
 #include "ERMs.h"
+#include "NetCDFGrid.h"
+#include "Dataset.h"
+#include "MineralDB.h"
+#include "DensityKernel.h"
 
 class T2Rho {
   QString PMethod;
   QString file_in;
   QString file_out;
+  QString NcVar;          // Variable name in NetCDF input, empty = first 3D
+  int NcSlab[6];          // Index ranges read from NetCDF input, -1 = all
+  int Threads;            // Number of threads in calcDensity(), 0 = all cores
   EarthReferenceModel * ERM;
   // Mineral properties
-  QList<double> m_rho;
-  QList<double> m_drhodX;
-  QList<double> m_K;
-  QList<double> m_dKdT;
-  QList<double> m_dKdP;
-  QList<double> m_dKdPdX;
-  QList<double> m_dKdX;
-  QList<double> m_alpha0;
-  QList<Point5D> data_out;
+  const MineralSet *DB;
+  bool AlphaT;            // True if alpha depends on T
+  Dataset Own;            // Points read by readFile()
+  Dataset *data;          // Input T and resulting density, Own or setInput()
   // Rock properties
   double r_XFe;
   QList<double> r_comp;
+  DensityKernel Kernel;   // Mineral constants combined for the rock
   // Functions
   bool SetPMethod(QString method);
   void argsError(QString val, bool ok);
   void setComp(QList<double> composition);
   void setComp(int c);
+  int threads();
+  void readNetCDF();
+  void writeNetCDF(QString header);
 
  public:
   T2Rho();
@@ -60,6 +72,8 @@ class T2Rho {
   void info();
   void readArgs(int &argc, char *argv[]);
   void readFile();
+  void setInput(Dataset *points) {data = points;}  // Instead of readFile()
+  void calcDensity();
   void writeFile();
 };
 
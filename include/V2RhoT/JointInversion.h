@@ -0,0 +1,66 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#ifndef JOINTINVERSION_H_
+#define JOINTINVERSION_H_
+
+#include <cmath>
+#include "RockModel.h"
+
+struct JointResult {
+  // Solution of JointInversion::invert() at one point
+  double T;               // Temperature / K
+  double c;               // Phase fraction or XFe
+  double rho;             // Density / kg/m3
+  double misfit;          // RMS of the P- and S-wave misfit / m/s
+  int steps;              // Newton steps
+};
+
+class JointInversion {
+/**
+Temperature and one compositional parameter of a rock from its P- and
+S-wave velocity at the same point. The unknown c is the fraction of one
+phase, the other phases being rescaled to keep the sum at 1, or XFe.
+
+Each step solves the 2x2 Newton system for the misfits of both velocities.
+The Jacobian is analytic, dV/dT and dV/dc are obtained by forward-mode
+differentiation of the rock model. A step is halved while it does not reduce
+the misfit. c is kept within [0, 1]; if the velocities require a value
+outside, c stays at the bound and T is fitted alone, leaving a misfit that
+the caller compares with its tolerance. The object is not modified by
+invert(), so one instance is used by all threads.
+**/
+  const RockModel *Base[2];  // P- and S-wave model of the base rock
+  RockParameter Unknown;
+  RockParameter None;     // Seeds no parameter, for dV/dT
+  double Comp[5];         // Base composition
+  double XFe;             // Base iron content
+  int MaxSteps;
+
+  void rock(double c, double comp[5], double &xfe) const;
+  double misfit(const RockModel *m[2], double Vp, double Vs, double P,
+                double T, RockProperties props[2]) const;
+
+ public:
+  JointInversion(const RockModel &p, const RockModel &s,
+                 const RockParameter &unknown);
+  double initial() const;
+  bool invert(double Vp, double Vs, double P, double T_start, double c_start,
+              double threshold, double c_threshold, JointResult &r) const;
+};
+
+#endif  // JOINTINVERSION_H_
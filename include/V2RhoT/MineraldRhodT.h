@@ -25,28 +25,28 @@
 #include <iostream>
 #include <math.h>
 #include "ANSIICodes.h"
+#include "MineralDB.h"
 
 class MineraldRhodT {
 /**
 This class hosts the mineral property dRho/dT
 It must be calculated numerically to avoid errors far away from the reference
-temperature. The values will be stored in arrays.
+temperature. The values will be stored in arrays. The mineral properties are
+those of Goes et al. (2000) from MineralDB.
 **/
   // Variables
   double Tmin, Tmax;
   QList <QList <double> > vals;
-  QList <double> alpha0, alpha1, alpha2, alpha3;
   int AlphaMode;
   // Functions
-  void set_alpha(int idx, double Ol, double Opx, double Cpx, double Sp,
-                 double Gnt);
   void fill();             // Calculate dRho/dT tables
 
  public:
   MineraldRhodT();
   bool set_AlphaMode(int mode);
-  double dRhodT(double T, int mineral);  // Returns dRhodT at T
-  void exportTable();
+  bool covers(double T) const {return T >= Tmin && T <= Tmax;}
+  double dRhodT(double T, int mineral) const;  // Returns dRhodT at T
+  void exportTable() const;
 };
 
 #endif // MINERALDRHODT_H_
@@ -0,0 +1,56 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#ifndef ROCKENSEMBLE_H_
+#define ROCKENSEMBLE_H_
+
+#include <QString>
+#include "MineralDB.h"
+#include "RockModel.h"
+
+struct RockUncertainty {
+  // Relative standard deviations of the parameters varied by RockEnsemble
+  double K, dKdT, dKdP;   // Bulk modulus and derivatives, per phase
+  double mu, dmudT, dmudP;  // Shear modulus and derivatives, per phase
+  double alpha;           // Thermal expansion, per phase
+  double a, A, H, V;      // Anelasticity, Goes et al. (2000) Eqn A6
+};
+
+class RockEnsemble {
+/**
+Monte Carlo realizations of the mineral properties and anelasticity
+parameters of a rock. Every parameter is multiplied with 1 + s*z, where s is
+its relative standard deviation and z a standard normal number. Mineral
+parameters vary independently for each phase, alpha0 to alpha3 of a phase by
+the same factor. Realization r is drawn from a random stream that depends on
+the seed and r only, so it is the same for any number of threads and any
+order in which the realizations are built.
+**/
+  MineralSet BaseSet;
+  QModel BaseQ;
+  RockUncertainty Sigma;
+  quint64 Seed;
+
+ public:
+  RockEnsemble(const MineralSet &db, const QModel &q,
+               const RockUncertainty &sigma, quint64 seed);
+  static RockUncertainty defaults();
+  static bool setSigma(RockUncertainty &sigma, QString name, double val);
+  void realization(int r, MineralSet &db, QModel &q) const;
+};
+
+#endif  // ROCKENSEMBLE_H_
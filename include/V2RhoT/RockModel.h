@@ -0,0 +1,140 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#ifndef ROCKMODEL_H_
+#define ROCKMODEL_H_
+
+#include <QString>
+#include <math.h>
+#include "Dual.h"
+#include "MineraldRhodT.h"
+#include "MineralDB.h"
+#include "PhysicalConstants.h"
+
+struct QModel {
+  // Anelasticity parameters of Q(P,T), Goes et al. (2000), Eqn A6
+  const char *Name;
+  double a;               // Frequency exponent
+  double A;               // Pre-factor
+  double H;               // Activation enthalpy / J/mol
+  double V;               // Activation volume / m3/mol
+};
+
+namespace Anelasticity {
+constexpr QModel Sobolev = {"Sobolev et al. (1996)", 0.15, 0.148, 500000.,
+                            0.00002};
+constexpr QModel Berckhemer = {"Berckhemer et al. (1982)", 0.25, 0.0002,
+                               584000., 0.000021};
+}  // namespace Anelasticity
+
+struct RockProperties {
+  // Properties of a rock at one pressure and temperature
+  double T;               // Temperature / K
+  double P;               // Pressure / Pa
+  double rho;             // Density / kg/m3
+  double K;               // VRH bulk modulus / Pa
+  double mu;              // VRH shear modulus / Pa
+  double Qmu;             // Shear quality factor
+  double QP;              // P-wave quality factor, 0 for S-waves
+  double dMdT;            // Anharmonic d<mu>/dT (S) or d<M>/dT (P) / Pa/K
+  double drhodT;          // kg/m3/K
+  double V;               // Synthetic velocity / m/s
+  double dVdT;            // m/s/K
+  bool inTable;           // False if T is outside of the dRho/dT table
+};
+
+struct RockParameter {
+  // Parameter a sensitivity is computed for, see RockModel::coefficients()
+  enum Kind {None, K, dKdT, dKdP, mu, dmudT, dmudP, alpha, a, A, H, V,
+             Comp, XFe};
+  Kind kind;
+  int phase;              // 0 to 4 for Ol to Gnt, -1 for all phases
+  static bool parse(QString name, RockParameter &p);
+};
+
+template <typename S>
+struct RockCoefficients {
+  // Inputs of the P/T dependent property chain, S is double or Dual
+  S Comp[5];
+  S rhoXFe[5];            // Density of each phase at XFe
+  S K[5], dKdT[5];
+  S dKdP[5];              // dKdP + XFe*dKdPdX
+  S KXFe[5];              // XFe*dKdX
+  S mu[5], dmudT[5], dmudP[5];
+  S muXFe[5];             // XFe*dmudX
+  S alpha[4][5];          // alpha0 to alpha3
+  S Qa, QH, QV;
+  S QPrefactor;           // A*omega^a
+  S tanQ;                 // tan(pi*a/2)
+};
+
+template <typename S>
+struct RockState {
+  // P/T dependent properties computed by the chain
+  S rho, K, mu, Qmu, QP, V;
+  S K_i[5], mu_i[5];      // Moduli of the phases
+};
+
+class RockModel {
+/**
+Synthetic velocity of a mantle rock after Goes et al. (2000), Appendix A.
+Everything that does not depend on P and T is combined when the model is
+built, afterwards it is never modified. evaluate() and invert() only read the
+model and return their results, so one model is used by any number of threads
+at once. The dRho/dT table is shared by all models.
+
+The chain from the parameters to density and velocity, state(), is a
+template on the scalar type. With Dual numbers it yields the derivatives of
+rho and V with respect to one parameter, from which sensitivities() derives
+dT/dparam and drho/dparam of a converted point.
+**/
+  const MineralSet *DB;   // Mineral properties
+  double Comp[5];         // Fractions of Ol, Opx, Cpx, Sp and Gnt
+  double XFe;             // Iron content
+  bool AlphaT;            // Temperature dependent thermal expansion
+  bool SWave;             // S- or P-wave velocity
+  QModel Q;
+  double T0, P0;          // Reference temperature / K and pressure / Pa
+  double Frequency;       // Hz
+  RockCoefficients<double> C;
+  double anh_sum1;        // Voigt part of the anharmonic derivative
+
+  void build();
+  template <typename S>
+  RockState<S> state(const RockCoefficients<S> &c, S P, S T) const;
+
+ public:
+  RockModel(const MineralSet &db, const double comp[5], double xfe,
+            bool alphaT, const QModel &q, double frequency, QString VelType,
+            double t0 = 273.15, double p0 = 0.0);
+  RockModel(const RockModel &base, const double comp[5], double xfe);
+  static const MineraldRhodT &table();
+  RockProperties evaluate(double P, double T) const;
+  bool invert(double V, double P, double T_start, double Fdamp,
+              double threshold, double &T, int &steps,
+              RockProperties &props) const;
+  template <typename S>
+  RockCoefficients<S> coefficients(const RockParameter &p) const;
+  Dual velocity(const RockCoefficients<Dual> &c, double P, Dual T) const;
+  void sensitivities(double P, double T,
+                     const RockCoefficients<Dual> *params, int n,
+                     double *dT, double *dRho) const;
+  double composition(int i) const {return Comp[i];}
+  double xfe() const {return XFe;}
+};
+
+#endif  // ROCKMODEL_H_
@@ -1,89 +1,161 @@
-/*******************************************************************************
-*                     Copyright (C) 2017 by Christian Meeßen                   *
-*                                                                              *
-*                          This file is part of VeloDT.                        *
-*                                                                              *
-*         VeloDT is free software: you can redistribute it and/or modify       *
-*     it under the terms of the GNU General Public License as published by     *
-*           the Free Software Foundation version 3 of the License.             *
-*                                                                              *
-*        VeloDT is distributed in the hope that it will be useful, but         *
-*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
-*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
-*                   General Public License for more details.                   *
-*                                                                              *
-*      You should have received a copy of the GNU General Public License       *
-*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
-*******************************************************************************/
-#ifndef V2RHOT_H_
-#define V2RHOT_H_
-
-#include <QDateTime>
-#include <QStringList>
-#include <ctime>
-#include <cmath>
-#include <stdlib.h>   //exit
-#include "ANSIICodes.h"
-#include "ERMs.h"
-#include "math.h"
-#include "PhysicalConstants.h"
-#include "PointClasses.h"
-#include "Rock.h"
-
-
-class V2RhoT {
-  QString File_In;        // Input file name of Vs grid
-  QString File_Out;       // Output file name
-
-  // Iteration properties
-  double c_Fdamp;         // Dampening
-  double count_avrg;      // Counts average iteration steps
-  double T_start;         // Starting temperature
-  double threshold;       // Threshold below which Newton iteration stops [degC]
-  bool use_t_crust;       // use crustal thickness to calculate P
-  bool ArbitraryPoints;   // If 'true' Vs input file is no regular point grid
-  QString VelType;        // Velocity type P or S
-  QString File_z_topo;    // EarthVision file of topographic elevation
-  QString File_t_crust;   // EarthVision file of crustal thickness
-  QString PMethod;        // String for pressure calculation method
-  double rho_crust;       // Crustal density [kg/m3]
-  double rho_mantle;      // Mantle density  [kg/m3]
-  double rho_avrg;        // Density used to calculate P, if use_t_crust = False
-  double scaleZ;          // Factor that all depth values are multiplied with
-  double scaleVs;         // Factor that all Vs values are multiplied with
-  bool verbose;           // True for debugging
-  bool petrel;            // Output Petrel points with attributes
-  Rock * MantleRock;      // The object that hosts the rock properties
-  EarthReferenceModel * ERM;  // Calculates pressure from an ERM
-
-  // Input data properties - 1: data_Vs, 2: t_crust, 3:z_topo
-  double x_min1, x_max1, y_min1, y_max1, z_min1, z_max1, x_min2, x_max2,
-         y_min2, y_max2, x_min3, x_max3, y_min3, y_max3;
-  int nX, nY, nZ;
-
-  QList <Point3D> z_topo;
-  QList <Point3D> t_crust;
-  QList <Point5D> data_V;
-  QList <Point5D> data_T;
-
-  bool SetPMethod(QString method);
-  double pressure(double x, double y, double z);
-  double pressure_crust(double x, double y, double z);
-  double pressure_simple(double z);
-  void argsError(QString val, bool ok);
-  void help();
-
- public:
-  V2RhoT();
-  ~V2RhoT();
-  QString FileIn() {return File_In;}
-  QString FileOut() {return File_Out;}
-  bool readFile(QString InName, QString InType);
-  bool saveFile(QString OutName);
-  void readArgs(int &argc, char *argv[]);
-  void usage();
-  bool Iterate();
-  void Info();
-};
-
-#endif //V2RHOT_H_
+/*******************************************************************************
+*                     Copyright (C) 2017 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#ifndef V2RHOT_H_
+#define V2RHOT_H_
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <QStringList>
+#include <QVector>
+#include <ctime>
+#include <cmath>
+#include <stdlib.h>   //exit
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "ANSIICodes.h"
+#include "Checkpoint.h"
+#include "JointInversion.h"
+#include "DataFile.h"
+#include "ERMs.h"
+#include "Dataset.h"
+#include "MapIndex.h"
+#include "NetCDFGrid.h"
+#include "math.h"
+#include "PhysicalConstants.h"
+#include "PointClasses.h"
+#include "Rock.h"
+#include "RockEnsemble.h"
+#include "StreamingStats.h"
+
+struct RockJob {
+  // One rock configuration of a run, see -jobs
+  QString FileOut;        // Output file name
+  Rock *MantleRock;       // Owned by V2RhoT
+  double count_avrg;      // Average iteration steps
+  int n_fail;             // Points without convergence
+};
+
+class V2RhoT {
+  QString File_In;        // Input file name of Vs grid
+  QString File_Out;       // Output file name
+  QString File_jobs;      // Table of further rock configurations
+  QString File_joint;     // Velocities of the other wave type, -joint
+
+  // Iteration properties
+  double c_Fdamp;         // Dampening
+  double T_start;         // Starting temperature
+  double threshold;       // Threshold below which Newton iteration stops [degC]
+  bool use_t_crust;       // use crustal thickness to calculate P
+  bool ArbitraryPoints;   // If 'true' Vs input file is no regular point grid
+  QString VelType;        // Velocity type P or S
+  QString File_z_topo;    // EarthVision file of topographic elevation
+  QString File_t_crust;   // EarthVision file of crustal thickness
+  QString PMethod;        // String for pressure calculation method
+  double rho_crust;       // Crustal density [kg/m3]
+  double rho_mantle;      // Mantle density  [kg/m3]
+  double rho_avrg;        // Density used to calculate P, if use_t_crust = False
+  double scaleZ;          // Factor that all depth values are multiplied with
+  double scaleVs;         // Factor that all Vs values are multiplied with
+  bool verbose;           // True for debugging
+  bool petrel;            // Output Petrel points with attributes
+  QString NcVar;          // Variable name in NetCDF input, empty = first 3D
+  int NcSlab[6];          // Index ranges read from NetCDF input, -1 = all
+  Dataset::Traversal Order;  // Order in which the points are processed
+  Rock * MantleRock;      // The object that hosts the rock properties
+  QStringList RockArgs;   // Rock options of the command line
+  double CustomFreq;      // Wave frequency / Hz given by -f, -1 = default
+  QList<RockJob> Jobs;    // MantleRock first, then those of File_jobs
+  int Threads;            // Number of threads, 0 = all cores
+  double CheckpointInterval;  // Seconds between checkpoints, 0 = none
+  bool Resume;            // Skip the points of an earlier checkpoint
+  bool Incremental;       // Reuse results of unchanged input, File_Out.chunks
+  int MCRealizations;     // Monte Carlo realizations, 0 = none
+  quint64 MCSeed;         // Seed of the realizations
+  RockUncertainty MCSigma;  // Relative standard deviations of the parameters
+  QList<double> MCQuantiles;  // Probabilities of the quantiles written
+  QStringList SensNames;  // Parameters of -sens
+  QVector<RockParameter> SensParams;
+  QString JointName;      // Unknown of the joint inversion
+  RockParameter JointParam;
+  QVector<double> V_joint;  // Velocities of File_joint / m/s
+  QString Settings;       // Options that determine the results
+  EarthReferenceModel * ERM;  // Calculates pressure from an ERM
+
+  // Input data properties - 1: data, 2: t_crust, 3:z_topo
+  double x_min1, x_max1, y_min1, y_max1, z_min1, z_max1, x_min2, x_max2,
+         y_min2, y_max2, x_min3, x_max3, y_min3, y_max3;
+  int nX, nY, nZ;
+
+  QVector <Point3D> z_topo;
+  QVector <Point3D> t_crust;
+  MapIndex TopoIndex;     // Lookup of z_topo entries
+  MapIndex CrustIndex;    // Lookup of t_crust entries
+  Dataset data;           // Input velocity and resulting T [degC] and rho
+
+  bool SetPMethod(QString method);
+  double pressure(double x, double y, double z);
+  double pressure_crust(double x, double y, double z);
+  double pressure_simple(double z);
+  void argsError(QString val, bool ok);
+  int rockArg(Rock *rock, const QStringList &arg, int i, double &freq);
+  void readJobs(QString FileName);
+  int threads();
+  double *temperatures(int job) {
+    return (job == 0) ? data.column(Dataset::T) : data.extra(2*job - 2);
+  }
+  double *densities(int job) {
+    return (job == 0) ? data.column(Dataset::Rho) : data.extra(2*job - 1);
+  }
+  QString checkpointFile() {return File_Out + ".ckpt";}
+  QByteArray packUnit(int job, const int *order, int k0, int k1,
+                      double sum, int n_fail);
+  bool unpackUnit(int job, const int *order, int k0, int k1,
+                  const char *rec, int size, double &sum, int &n_fail);
+  QString chunkFile() {return File_Out + ".chunks";}
+  QByteArray jobSettings(int job);
+  quint64 chunkKey(const QByteArray &settings, const int *order, int k0,
+                   int k1, const double *P);
+  bool monteCarlo(const double *P, const int *order);
+  QStringList extraColumns(QList<int> &cols, QStringList &units,
+                           QStringList &long_names);
+  void sensitivities(const double *P);
+  bool jointInversion(const double *P, const int *order);
+  bool readNetCDF(QString InName);
+  bool saveNetCDF(QString OutName, QString Info_header, int job);
+  void help();
+
+ public:
+  V2RhoT();
+  ~V2RhoT();
+  QString FileIn() {return File_In;}
+  QString FileJoint() {return File_joint;}
+  QString FileOut(int job = 0) {return Jobs[job].FileOut;}
+  int jobs() {return Jobs.size();}
+  bool readFile(QString InName, QString InType);
+  bool readJoint(QString InName);
+  bool saveFile(QString OutName, int job = 0);
+  void readArgs(int &argc, char *argv[]);
+  void usage();
+  bool Iterate();
+  void removeCheckpoint();
+  void Info();
+};
+
+#endif //V2RHOT_H_
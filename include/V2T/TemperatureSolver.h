@@ -0,0 +1,97 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#ifndef TEMPERATURESOLVER_H_
+#define TEMPERATURESOLVER_H_
+
+#include <QtGlobal>
+#include <math.h>
+#include "Dataset.h"
+#include "PhysicalConstants.h"
+
+struct Calibration {
+  // Constants of the Vs-T relation of Priestley and McKenzie (2006)
+  double bV;              // 1/km
+  double m;               // km/s/degC
+  double c;               // km/s
+  double A;               // km/s
+  double E;               // kJ/mol
+  double Va;              // m3/mol
+};
+
+class TemperatureSolver {
+/**
+Temperature from Vs after Priestley and McKenzie (2006). Points are solved
+Lanes at a time. All methods only read the settings, so one solver is used by
+several threads at once. V2T and libvelodt share it.
+**/
+ public:
+  enum InitialGuess {Fixed, LambertW};
+  enum RootFinder {Newton, Halley};
+  static const int Lanes = 8;  // Points solved together by temperatures()
+
+  InitialGuess Guess;     // Start of the Newton iteration
+  RootFinder Solver;      // Method of solving for the temperature
+  double threshold;       // Threshold below which the iteration stops [degC]
+  double T_min, T_max;    // Bracket of the Halley root finder / degC
+  double c_K;             // degC to Kelvin
+
+  TemperatureSolver();
+  static Calibration defaults();
+  static double corrected(const Calibration &p, double Vs, double z) {
+    // Vs* / km/s at z / m, see Priestley and McKenzie (2006), Eqn 3
+    return Vs/(1+p.bV*(fabs(z)/1000.0 - 50.0));
+  }
+  static double activation(const Calibration &p, double P) {
+    // Exponent of the anelastic term times (T + c_K), per point / K
+    return (p.E*1000 + P*p.Va)/c_R;
+  }
+  void fdf(const Calibration &p, double VsS, double H, double T, double &f,
+           double &df) const {
+    /**
+    Temperature function f(T) = c_m*T - VsS + c_c + c_A*exp(-H/(T + c_K)) and
+    its derivative, Priestley and McKenzie (2006), Eqns 4 and 5, sharing one
+    exp. H is given by activation().
+    **/
+    double TK = 1/(T + c_K);
+    double e = p.A*exp(-H*TK);
+    f = p.m*T - VsS + p.c + e;
+    df = p.m + e*H*TK*TK;
+  }
+  void fdf2(const Calibration &p, double VsS, double H, double T, double &f,
+            double &df, double &d2f) const {
+    // As fdf(), plus d2f = c_A*exp(-H/u)*H/u^3*(H/u - 2) with u = T + c_K
+    double TK = 1/(T + c_K);
+    double e = p.A*exp(-H*TK);
+    f = p.m*T - VsS + p.c + e;
+    df = p.m + e*H*TK*TK;
+    d2f = e*H*TK*TK*TK*(H*TK - 2);
+  }
+  double initialGuess(const Calibration &p, double VsS, double H) const;
+  static double lambertW(double lnz);
+  void temperatures(int n, const Calibration *p, const double *VsS,
+                    const double *H, double *T, int *steps, int *stat) const;
+  void convert(int n, const Calibration &p, const double *z, const double *Vs,
+               const double *P, double *T, int *stat) const;
+
+ private:
+  void halley(int n, const Calibration *p, const double *VsS,
+              const double *H, double *T, int *steps, int *stat,
+              bool *active) const;
+};
+
+#endif  // TEMPERATURESOLVER_H_
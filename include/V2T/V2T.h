@@ -18,16 +18,27 @@
 #ifndef V2T_H_
 #define V2T_H_
 
+#include <algorithm>
 #include <ctime>
 #include <QString>
 #include <QList>
+#include <QVector>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QStringList>
 #include <stdlib.h>  //exit
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "ANSIICodes.h"
+#include "DataFile.h"
 #include "PointClasses.h"
 #include "math.h"
 #include "ERMs.h" // Stores ERMs
+#include "Dataset.h"
+#include "MapIndex.h"
+#include "NetCDFGrid.h"
+#include "TemperatureSolver.h"
 #include "PhysicalConstants.h"
 
 
@@ -48,43 +59,55 @@ class V2T {
   double scaleZ;          // Mutliply all depth with this factor, default = 1
   double scaleVs;         // Multiply all vs with this factor, default = 1
   bool verbose;           // True = display parameters during calculation
+  QString NcVar;          // Variable name in NetCDF input, empty = first 3D
+  int NcSlab[6];          // Index ranges read from NetCDF input, -1 = all
+  Dataset::Traversal Order;  // Order in which the points are processed
+  int Threads;            // Number of threads in newton(), 0 = all cores
+  TemperatureSolver Kernel;  // Root finder and its settings
+  int TableSize[2];       // Lookup table nodes in VsS and P, 0 = no table
+  double TableVsS[2];     // First VsS and spacing of the table / km/s
+  double TableP[2];       // First P and spacing of the table / Pa
+  double TableError;      // Maximum interpolation error of the table / degC
+  QVector<double> Table;  // Temperatures, VsS varying fastest / degC
   EarthReferenceModel * ERM;
 
-  // Properties for Newton iteration method
-  double threshold;       // Threshold below which Newton iteration stops [degC]
+  // Constants, several parameter sets are converted together as ensemble
+  QVector<Calibration> Members;  // Parameter sets, the first one by default
+  QString File_params;    // File with parameter sets, empty = default set
+  bool EnsembleStats;     // Write mean, std, min, max instead of all members
 
-  // Constants
-  double c_bV;            // 1/km
-  double c_m;             // km/s/degC
-  double c_c;             // km/s
-  double c_A;             // km/s
-  double c_E;             // kJ/mol
-  double c_Va;            // m3/mol
-  double c_K;             // degC to Kelvin
-
-  // Input data properties - 1: data_Vs, 2: t_crust, 3:z_topo
+  // Input data properties - 1: data, 2: t_crust, 3:z_topo
   double x_min1, x_max1, y_min1, y_max1, z_min1, z_max1;
   double x_min2, x_max2, y_min2, y_max2;
   double x_min3, x_max3, y_min3, y_max3;
   int nX, nY, nZ;
 
-  QList <Point3D> z_topo;
-  QList <Point3D> t_crust;
-  QList <Point4D> data_Vs;
-  QList <Point4D> data_T;
-  QList <double> data_Vcalc;
+  QVector <Point3D> z_topo;
+  QVector <Point3D> t_crust;
+  MapIndex TopoIndex;     // Lookup of z_topo entries
+  MapIndex CrustIndex;    // Lookup of t_crust entries
+  Dataset data;           // Input Vs, resulting T and Vs at T
   QList <double> ERMz;    // List for depth values of the Earth reference model
   QList <double> ERMrho;  // List for density values of the ERM
 
   void usage_extended();
   void argsError(QString val, bool ok);
   bool SetPMethod(QString method);
-  double ftheta(double VsS, double P, double T);
-  double dfdtheta(double P, double T);
+  int threads();
+  static const int Lanes = TemperatureSolver::Lanes;
+  bool ensemble() const {return Members.size() > 1;}
+  void buildTable(double VsS_min, double VsS_max, double P_min,
+                  double P_max);
+  double lookup(double VsS, double P);
+  void prepare(int i, double &VsS, double &P);
   double pressure(double x, double y, double z);
   double pressure_simple(double z);
   double pressure_crust(double x, double y, double z);
   void WRITE_P(QString method);
+  bool readParams(QString FileName);
+  QStringList ensembleColumns(QList<int> &cols);
+  bool readNetCDF(QString InName);
+  bool saveNetCDF(QString OutName, QString T_info);
 
  public:
   V2T();
@@ -101,6 +124,7 @@ class V2T {
   QString FileTCrust() {return File_t_crust;}
   QString FileOut() {return File_Out;}
   bool UseCrust() {return use_t_crust;}
+  Dataset *dataset() {return &data;}
 };
 
 #endif // V2T_H_
@@ -0,0 +1,101 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <QVector>
+#include <QtGlobal>
+#include <stddef.h>
+#include <string.h>
+
+class Arena {
+/**
+Bump-pointer allocator for the buffers of one run. Memory is requested from the
+system in large blocks and handed out in 64 byte aligned pieces. Nothing is
+freed individually, all blocks are released together when the arena is
+destroyed.
+**/
+  struct Block {
+    char *data;
+    size_t size;
+    size_t used;
+  };
+  QVector<Block> Blocks;
+  size_t BlockSize;       // Minimum size of a block [bytes]
+  Q_DISABLE_COPY(Arena)
+
+ public:
+  explicit Arena(size_t blockSize = 64 << 20);
+  ~Arena();
+  void *allocate(size_t bytes);
+  bool extend(void *p, size_t oldBytes, size_t newBytes);
+};
+
+template <typename T>
+class ArenaArray {
+/**
+Growable array of trivially copyable values that lives in an Arena. If the
+array was the last allocation of the arena it grows in place, otherwise it is
+moved to a new piece with twice the capacity. Copies share the storage.
+**/
+  Arena *Pool;
+  T *Data;
+  int Size;
+  int Capacity;
+
+ public:
+  ArenaArray() : Pool(NULL), Data(NULL), Size(0), Capacity(0) {}
+  explicit ArenaArray(Arena *pool)
+    : Pool(pool), Data(NULL), Size(0), Capacity(0) {}
+
+  void reserve(int n) {
+    if (n <= Capacity)
+      return;
+    if (Data != NULL && Pool->extend(Data, Capacity*sizeof(T), n*sizeof(T))) {
+      Capacity = n;
+      return;
+    }
+    T *d = static_cast<T *>(Pool->allocate(n*sizeof(T)));
+    if (Size > 0)
+      memcpy(d, Data, Size*sizeof(T));
+    Data = d;
+    Capacity = n;
+  }
+  void append(const T &val) {
+    if (Size == Capacity)
+      reserve(Capacity < 1024 ? 1024 : 2*Capacity);
+    Data[Size++] = val;
+  }
+  void resize(int n) {
+    reserve(n);
+    Size = n;
+  }
+  void fill(const T &val, int n) {
+    resize(n);
+    for (int i=0; i < n; i++)
+      Data[i] = val;
+  }
+  void clear() {Size = 0;}
+  int size() const {return Size;}
+  T *data() {return Data;}
+  const T *constData() const {return Data;}
+  T &operator[](int i) {return Data[i];}
+  const T &operator[](int i) const {return Data[i];}
+};
+
+#endif  // ARENA_H_
@@ -0,0 +1,60 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QString>
+
+class Checkpoint {
+/**
+Binary side file of a long conversion that holds the results of completed
+work units, so that an interrupted run can be resumed. The file starts with a
+header identifying the run (magic, signature of input size and settings),
+followed by one record per unit: unit index, record size and the packed
+results. Records are only appended and read one at a time, a record cut off
+by a kill is dropped by read() and cut from the file by resume(). The content
+of a record is up to the caller, hash() gives a key for records that are
+looked up by their input.
+**/
+  QFile File;
+  QString Error;
+  bool Failed;            // A write failed since the last flush()
+  qint64 End;             // End of the last complete record found by read()
+
+  void write(const char *data, qint64 size);
+
+ public:
+  explicit Checkpoint(QString FileName);
+  bool start(const QByteArray &signature);
+  bool read(const QByteArray &signature, QList<int> &units,
+            QList<QByteArray> &records);
+  bool resume(const QByteArray &signature, QList<int> &units,
+              QList<QByteArray> &records);
+  void append(int unit, const QByteArray &record);
+  bool flush();
+  bool remove();
+  QString fileName() const {return File.fileName();}
+  QString error() const {return Error;}
+  static quint64 hash(const char *data, qint64 size,
+                      quint64 h = 14695981039346656037ULL);
+};
+
+#endif  // CHECKPOINT_H_
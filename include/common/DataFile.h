@@ -0,0 +1,51 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#ifndef DATAFILE_H_
+#define DATAFILE_H_
+
+#include <QFile>
+#include <QIODevice>
+#include <QString>
+#include <stdio.h>
+#include <stdlib.h>
+#include "ANSIICodes.h"
+
+class DataFile {
+/**
+Opens an input or output data file. Files ending with .gz or .zst are streamed
+through an external (de)compressor that runs as a separate process, so that
+(de)compression and parsing/formatting are pipelined. Compression uses all
+available cores (pigz, zstd -T0) when the tools are installed.
+**/
+  QString FileName;
+  QString Compression;    // "none", "gzip" or "zstd"
+  QFile file;
+  FILE * pipe;            // Pipe to the (de)compressor, NULL for plain files
+  QString command(QIODevice::OpenMode mode);
+
+ public:
+  DataFile(QString name);
+  ~DataFile();
+  bool open(QIODevice::OpenMode mode);
+  bool close();
+  QIODevice * device() {return &file;}
+  QString compression() {return Compression;}
+  static int countRows(QString name);
+};
+
+#endif // DATAFILE_H_
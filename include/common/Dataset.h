@@ -0,0 +1,81 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#ifndef DATASET_H_
+#define DATASET_H_
+
+#include <QVector>
+#include <math.h>
+#include "Arena.h"
+#include "GridGeometry.h"
+
+class Dataset {
+/**
+Column store of the points processed by the tools. Coordinates are held by a
+GridGeometry, i.e. implicitly for regular grids. Every other quantity is one
+contiguous array, so that the conversion kernels stream over single columns.
+column(), iterations() and status() give direct access to the arrays without
+copying. All arrays of a run are allocated from one Arena owned by the
+dataset and are released together with it.
+
+Readers append the coordinates together with the input column, allocate()
+then sizes all result columns to the number of points. Results that do not
+fit into the fixed columns, e.g. one temperature per parameter set, go into
+extra columns of the same length. order() gives the
+sequence in which the kernels visit the points; results are always stored in
+the slot of the point.
+**/
+ public:
+  enum Column {V, VCalc, T, Rho, nColumns};
+  enum Status {Ok = 0, ZeroDivision, NotConverged};
+  enum Traversal {FileOrder, Morton};
+
+ private:
+  Arena Memory;           // Must be declared first, owns all arrays below
+  GridGeometry Nodes;
+  ArenaArray<double> Cols[nColumns];
+  ArenaArray<int> Iter;   // Iteration steps per point
+  ArenaArray<int> Stat;   // Status per point
+  ArenaArray<int> Sequence;  // Order in which the points are processed
+  QVector<ArenaArray<double> > Extra;  // Additional result columns
+  Q_DISABLE_COPY(Dataset)
+
+ public:
+  Dataset();
+  void setGrid(int nx, int ny, int nz);
+  void reserve(int n);
+  void append(double x, double y, double z, Column c, double val);
+  void allocate();
+  void allocateExtra(int n);
+
+  int size() const {return Nodes.size();}
+  bool isRegular() const {return Nodes.isRegular();}
+  double x(int n) const {return Nodes.x(n);}
+  double y(int n) const {return Nodes.y(n);}
+  double z(int n) const {return Nodes.z(n);}
+  double *column(Column c) {return Cols[c].data();}
+  const double *column(Column c) const {return Cols[c].constData();}
+  int extraColumns() const {return Extra.size();}
+  double *extra(int k) {return Extra[k].data();}
+  const double *extra(int k) const {return Extra[k].constData();}
+  int *iterations() {return Iter.data();}
+  int *status() {return Stat.data();}
+  int count(Status s) const;
+  const int *order(Traversal t);
+};
+
+#endif  // DATASET_H_
@@ -0,0 +1,84 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#ifndef DUAL_H_
+#define DUAL_H_
+
+#include <math.h>
+
+struct Dual {
+/**
+Dual number v + d*eps with eps^2 = 0 for forward-mode automatic
+differentiation. A calculation written for a template scalar type returns,
+with Dual, its value in v and its derivative along the seeded inputs in d.
+Only the operations used by the rock property chain are defined.
+**/
+  double v;   // Value
+  double d;   // Derivative
+
+  Dual(double val = 0, double der = 0) : v(val), d(der) {}
+};
+
+inline Dual operator-(const Dual &a) {return Dual(-a.v, -a.d);}
+inline Dual operator+(const Dual &a, const Dual &b) {
+  return Dual(a.v + b.v, a.d + b.d);
+}
+inline Dual operator-(const Dual &a, const Dual &b) {
+  return Dual(a.v - b.v, a.d - b.d);
+}
+inline Dual operator*(const Dual &a, const Dual &b) {
+  return Dual(a.v*b.v, a.d*b.v + a.v*b.d);
+}
+inline Dual operator/(const Dual &a, const Dual &b) {
+  return Dual(a.v/b.v, (a.d*b.v - a.v*b.d)/(b.v*b.v));
+}
+inline Dual operator+(const Dual &a, double b) {return Dual(a.v + b, a.d);}
+inline Dual operator+(double a, const Dual &b) {return Dual(a + b.v, b.d);}
+inline Dual operator-(const Dual &a, double b) {return Dual(a.v - b, a.d);}
+inline Dual operator-(double a, const Dual &b) {return Dual(a - b.v, -b.d);}
+inline Dual operator*(const Dual &a, double b) {return Dual(a.v*b, a.d*b);}
+inline Dual operator*(double a, const Dual &b) {return Dual(a*b.v, a*b.d);}
+inline Dual operator/(const Dual &a, double b) {return Dual(a.v/b, a.d/b);}
+inline Dual operator/(double a, const Dual &b) {
+  return Dual(a/b.v, -a*b.d/(b.v*b.v));
+}
+
+// Value and derivative of either scalar type, seed() ignores double
+inline double value(double a) {return a;}
+inline double value(const Dual &a) {return a.v;}
+inline void seed(double &, double) {}
+inline void seed(Dual &a, double der) {a.d = der;}
+
+inline Dual exp(const Dual &a) {
+  double e = exp(a.v);
+  return Dual(e, e*a.d);
+}
+inline Dual sqrt(const Dual &a) {
+  double s = sqrt(a.v);
+  return Dual(s, a.d/(2.*s));
+}
+inline Dual tan(const Dual &a) {
+  double t = tan(a.v);
+  return Dual(t, (1. + t*t)*a.d);
+}
+inline Dual pow(double a, const Dual &b) {
+  // a^b for a > 0
+  double p = pow(a, b.v);
+  return Dual(p, p*log(a)*b.d);
+}
+
+#endif  // DUAL_H_
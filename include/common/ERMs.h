@@ -32,14 +32,17 @@
 class EarthReferenceModel {
   QList <double> ERMz;
   QList <double> ERMrho;
+  QVector <double> Bottom;  // Depth of the bottom of each layer / m
+  QVector <double> Top;     // Pressure at the top of each layer / Pa
   QString ERMtype;
   bool INIT_AK135();
   bool INIT_PREM();
+  void integrate();
  public:
   EarthReferenceModel();
   EarthReferenceModel(QString type);
   bool set(QString type);
-  double pressure(double z);
+  double pressure(double z) const;
   QString type() {return ERMtype;}
   bool writeP();
   bool writeP(double dz);
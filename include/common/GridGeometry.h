@@ -0,0 +1,69 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#ifndef GRIDGEOMETRY_H_
+#define GRIDGEOMETRY_H_
+
+#include <QVector>
+#include <math.h>
+#include "Arena.h"
+
+class GridGeometry {
+/**
+Coordinates of the nodes of a data set, in the order the nodes were appended.
+
+If the size of a regular grid is known (Grid_size in GMS files), only the
+coordinates along the three axes and the order in which the axes vary in the
+file are stored. The coordinates of node n are computed on demand. The axis
+order is detected from the nodes themselves, so files with x, y or z varying
+fastest are supported. As soon as a node does not fit the grid, all
+coordinates are stored explicitly.
+**/
+  int N[3];                 // Number of nodes along x, y and z
+  int Order[3];             // Axes from fastest to slowest varying
+  int nOrder;               // Number of axes in Order
+  int Block;                // Number of nodes spanned by the axes in Order
+  int Count;                // Number of nodes
+  bool Regular;             // True if coordinates are computed from Axis
+  QVector<double> Axis[3];  // Coordinates along x, y and z
+  ArenaArray<double> X, Y, Z;  // Explicit coordinates if not Regular
+
+  bool fits(int n, const double c[3]);
+  void makeExplicit();
+  int index(int n, int axis) const {
+    // Index of node n along axis
+    for (int o=0; o < nOrder; o++) {
+      if (Order[o] == axis)
+        return n % N[axis];
+      n /= N[Order[o]];
+    }
+    return 0;
+  }
+
+ public:
+  explicit GridGeometry(Arena *pool);
+  void setSize(int nx, int ny, int nz);
+  void reserve(int n);
+  void append(double x, double y, double z);
+  bool isRegular() const {return Regular;}
+  int size() const {return Count;}
+  double x(int n) const {return Regular ? Axis[0][index(n, 0)] : X[n];}
+  double y(int n) const {return Regular ? Axis[1][index(n, 1)] : Y[n];}
+  double z(int n) const {return Regular ? Axis[2][index(n, 2)] : Z[n];}
+};
+
+#endif  // GRIDGEOMETRY_H_
@@ -0,0 +1,39 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#ifndef MAPINDEX_H_
+#define MAPINDEX_H_
+
+#include <QMap>
+#include <QVector>
+#include "PointClasses.h"
+
+class MapIndex {
+/**
+Finds the entry of a map (topography, crustal thickness) that belongs to a
+point, i.e. the first entry with the same x and y coordinate, without scanning
+the map for every point. The index is not modified after build(), so it can be
+used from several threads.
+**/
+  QMap<double, QMap<double, int> > Entry;   // Entry[x][y], first occurrence
+
+ public:
+  void build(const QVector<Point3D> &map);
+  int find(double x, double y) const;
+};
+
+#endif  // MAPINDEX_H_
@@ -0,0 +1,104 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#ifndef MINERALDB_H_
+#define MINERALDB_H_
+
+#include <QString>
+
+struct MineralSet {
+/**
+Elastic and thermal properties of the five mantle phases Ol, Opx, Cpx, Sp and
+Gnt, in this order. All sets are compile-time constants so that the kernels
+using them need no tables at start-up.
+**/
+  const char *Name;   // Reference printed in the info section
+  double rho[5];      // Density at T0 and P0 / kg/m3
+  double drhodX[5];   // / kg/m3
+  double K[5];        // Bulk modulus / Pa
+  double dKdT[5];     // / Pa/K
+  double dKdP[5];     // / Pa/Pa
+  double dKdPdX[5];   // / Pa/Pa
+  double dKdX[5];     // / Pa
+  double mu[5];       // Shear modulus / Pa
+  double dmudT[5];    // / Pa/K
+  double dmudP[5];    // / Pa/Pa
+  double dmudX[5];    // / Pa
+  double alpha0[5];   // Thermal expansion, alpha(T) = alpha0 + alpha1*T
+  double alpha1[5];   //   + alpha2/T + alpha3/T^2 with T in K
+  double alpha2[5];
+  double alpha3[5];
+
+  constexpr double alpha(int i, double T) const {
+    return alpha0[i] + alpha1[i]*T + alpha2[i]/T + alpha3[i]/T/T;
+  }
+};
+
+namespace MineralDB {
+
+// Tab. A1 in Goes et al. (2000)
+constexpr MineralSet Goes = {
+  "Goes et al. (2000)",
+  {3222.0, 3198.0, 3280.0, 3578.0, 3565.0},
+  {1182.0, 804.0, 377.0, 702.0, 758.0},
+  {1.29E+11, 1.11E+11, 1.05E+11, 1.98E+11, 1.73E+11},
+  {-1.60E+07, -1.20E+07, -1.30E+07, -2.80E+07, -2.10E+07},
+  {4.2, 6.0, 6.2, 5.7, 4.9},
+  {0, 0, -1.9, 0, 0},
+  {0.0, -10E9, 13E9, 12E9, 7E9},
+  {8.20E+10, 8.10E+10, 6.70E+10, 1.08E+11, 9.20E+10},
+  {-1.40E+07, -1.10E+07, -1.00E+07, -1.20E+07, -1.00E+07},
+  {1.4, 2.0, 1.7, 0.8, 1.4},
+  {-30E9, -29E9, -6E9, -24E9, -7E9},
+  {2.01E-5, 3.871E-5, 3.206E-5, 6.969E-5, 9.91E-6},
+  {1.39E-8, 4.46E-9, 8.11E-9, -1.08E-9, 1.165E-8},
+  {0.001627, 0.000343, 0.001347, -0.030799, 0.010624},
+  {-0.338, -1.7278, -1.8167, 5.0395, -2.5}
+};
+
+// Cammarano et al. (2003), spinel from Goes et al. (2000)
+constexpr MineralSet Cammarano = {
+  "Cammarano et al. (2003), Sp: Goes et al. (2000)",
+  {3222, 3215, 3277, 3578, 3565},
+  {1182, 799, 380, 702, 0},
+  {129E9, 109E9, 105E9, 198E9, 171E9},
+  {-17E6, -27E6, -13E6, -28E6, -19E6},
+  {4.2, 7, 6.2, 5.7, 4.4},
+  {0, 0, -1.9, 0, 0},
+  {0, 20E9, 12E9, 12E9, 0},
+  {81E9, 75E9, 67E9, 108E9, 92E9},
+  {-14E6, -12E6, -10E6, -12E6, -10E6},
+  {1.4, 1.6, 1.7, 0.8, 1.4},
+  {-31E9, 10E9, -6E9, -24E9, 0},
+  {0.0000201, 0.000044135, 0.000053, 0.00006969, 0.00000991},
+  {1.39E-08, 6.61E-09, 5.92E-09, -1.08E-09, 1.17E-08},
+  {0.001627, -0.00575625, -0.0122, -0.030799, 0.0106},
+  {-0.338, -0.08385, 0.672, 5.0395, -2.5}
+};
+
+inline const MineralSet *find(QString name) {
+  // Set by its short name, 0 if unknown
+  if (name == "Goes")
+    return &Goes;
+  if (name == "Cammarano")
+    return &Cammarano;
+  return 0;
+}
+
+}  // namespace MineralDB
+
+#endif  // MINERALDB_H_
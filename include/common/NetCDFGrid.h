@@ -0,0 +1,69 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#ifndef NETCDFGRID_H_
+#define NETCDFGRID_H_
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <math.h>
+
+struct NetCDFVariable {
+  QString name;
+  QString long_name;
+  QString units;
+  const double *vals;     // One value per point, not owned
+};
+
+class NetCDFGrid {
+/**
+Reads and writes 3D volumes following the CF conventions. Requires building
+with 'qmake CONFIG+=netcdf', otherwise read() and write() return false.
+
+Values are stored with x varying fastest, i.e. node (i, j, k) has the index
+(k*nY + j)*nX + i. Reading can be restricted to a hyperslab of index ranges so
+that sub-volumes are processed without loading the whole file.
+**/
+  QString Error;
+  QVector<double> X, Y, Z;   // Coordinate axes
+  QVector<double> Vals;      // Values of the variable that was read
+  int slab[6];               // First and last index in x, y, z, -1: all
+  int findAxis(const QVector<double> &axis, double val);
+
+ public:
+  NetCDFGrid();
+  static bool isNetCDF(QString FileName) {return FileName.endsWith(".nc");}
+  void setSlab(int x0, int x1, int y0, int y1, int z0, int z1);
+  bool read(QString FileName, QString VarName);
+  bool write(QString FileName, const QVector<double> &x,
+             const QVector<double> &y, const QVector<double> &z,
+             const QList<NetCDFVariable> &vars, QString comment);
+
+  int nX() {return X.size();}
+  int nY() {return Y.size();}
+  int nZ() {return Z.size();}
+  int size() {return Vals.size();}
+  double x(int n) {return X[n % X.size()];}
+  double y(int n) {return Y[(n / X.size()) % Y.size()];}
+  double z(int n) {return Z[n / (X.size()*Y.size())];}
+  double value(int n) {return Vals[n];}
+  QString error() {return Error;}
+};
+
+#endif // NETCDFGRID_H_
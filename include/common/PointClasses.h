@@ -15,74 +15,96 @@
 *      You should have received a copy of the GNU General Public License       *
 *        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
 *******************************************************************************/
-#include <QList>
 #ifndef POINTCLASSES_H_
 #define POINTCLASSES_H_
 
+#include <QtGlobal>
+
+/*******************************************************************************
+Points are plain fixed-size arrays of doubles. They are trivially copyable and
+declared as primitive types to Qt, so QVector<PointND> stores them contiguously
+without a heap allocation per point.
+*******************************************************************************/
+
 class Point2D {
-private:
-  QList <double> Vals;
-public:
-  Point2D();
-  Point2D(double x, double y);
-  // Assigning properties
-  void setX(double x){Vals[0]=x;}
-  void setY(double y){Vals[1]=y;}
-  // Retrieving properties
-  double x(){return Vals[0];}
-  double y(){return Vals[1];}
-  // Operators
-  double &operator[](int idx);
+  private:
+    double Vals[2];
+  public:
+    Point2D() {Vals[0] = Vals[1] = 0.0;}
+    Point2D(double x, double y) {Vals[0] = x; Vals[1] = y;}
+    // Assigning properties
+    void setX(double x){Vals[0]=x;}
+    void setY(double y){Vals[1]=y;}
+    // Retrieving properties
+    double x() const {return Vals[0];}
+    double y() const {return Vals[1];}
+    // Operators
+    double &operator[](int idx) {return Vals[idx];}
+    double operator[](int idx) const {return Vals[idx];}
 };
 
 class Point3D {
   private:
-    QList <double> Vals;
+    double Vals[3];
   public:
-    Point3D();
-    Point3D(double x, double y, double z);
+    Point3D() {Vals[0] = Vals[1] = Vals[2] = 0.0;}
+    Point3D(double x, double y, double z) {
+      Vals[0] = x;
+      Vals[1] = y;
+      Vals[2] = z;
+    }
     // Assigning properties
     void setX(double x){Vals[0]=x;}
     void setY(double y){Vals[1]=y;}
     void setZ(double z){Vals[2]=z;}
     // Retrieving properties
-    double x(){return Vals[0];}
-    double y(){return Vals[1];}
-    double z(){return Vals[2];}
+    double x() const {return Vals[0];}
+    double y() const {return Vals[1];}
+    double z() const {return Vals[2];}
     // Operators
-    double &operator[](int idx);
-    Point3D &operator=(Point3D p);
+    double &operator[](int idx) {return Vals[idx];}
+    double operator[](int idx) const {return Vals[idx];}
 };
 
 class Point4D {
   private:
-    QList <double> Vals;
+    double Vals[4];
   public:
-    Point4D();
-    Point4D(double x, double y, double z, double v);
+    Point4D() {Vals[0] = Vals[1] = Vals[2] = Vals[3] = 0.0;}
+    Point4D(double x, double y, double z, double v) {
+      Vals[0] = x;
+      Vals[1] = y;
+      Vals[2] = z;
+      Vals[3] = v;
+    }
     // Assigning properties
     void setX(double x){Vals[0]=x;}
     void setY(double y){Vals[1]=y;}
     void setZ(double z){Vals[2]=z;}
     void setV(double v){Vals[3]=v;}
     // Retrieving properties
-    double x(){return Vals[0];}
-    double y(){return Vals[1];}
-    double z(){return Vals[2];}
-    double v(){return Vals[3];}
+    double x() const {return Vals[0];}
+    double y() const {return Vals[1];}
+    double z() const {return Vals[2];}
+    double v() const {return Vals[3];}
     double *p(int i){return &Vals[i];}
     // Operators
-    double &operator[](int idx);
-    Point4D &operator=(Point4D p);
+    double &operator[](int idx) {return Vals[idx];}
+    double operator[](int idx) const {return Vals[idx];}
 };
 
-
 class Point5D {
   private:
-    QList <double> Vals;
+    double Vals[5];
   public:
-    Point5D();
-    Point5D(double x, double y, double z, double v, double prop);
+    Point5D() {Vals[0] = Vals[1] = Vals[2] = Vals[3] = Vals[4] = 0.0;}
+    Point5D(double x, double y, double z, double v, double prop) {
+      Vals[0] = x;
+      Vals[1] = y;
+      Vals[2] = z;
+      Vals[3] = v;
+      Vals[4] = prop;  // Another property, e.g. rho or T
+    }
     // Assigning properties
     void setX(double x){Vals[0]=x;}
     void setY(double y){Vals[1]=y;}
@@ -90,15 +112,20 @@ class Point5D {
     void setV(double v){Vals[3]=v;}
     void setProp(double prop){Vals[4]=prop;}
     // Retrieving properties
-    double x(){return Vals[0];}
-    double y(){return Vals[1];}
-    double z(){return Vals[2];}
-    double v(){return Vals[3];}
-    double prop(){return Vals[4];}
-
-    double &operator[](int idx);
-    Point5D &operator=(Point5D p);
+    double x() const {return Vals[0];}
+    double y() const {return Vals[1];}
+    double z() const {return Vals[2];}
+    double v() const {return Vals[3];}
+    double prop() const {return Vals[4];}
     double *p(int i){return &Vals[i];}
+    // Operators
+    double &operator[](int idx) {return Vals[idx];}
+    double operator[](int idx) const {return Vals[idx];}
 };
 
+Q_DECLARE_TYPEINFO(Point2D, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(Point3D, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(Point4D, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(Point5D, Q_PRIMITIVE_TYPE);
+
 #endif // POINTCLASSES_H_
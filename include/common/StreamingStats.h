@@ -0,0 +1,59 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#ifndef STREAMINGSTATS_H_
+#define STREAMINGSTATS_H_
+
+#include <QList>
+#include <QVector>
+#include <math.h>
+
+class StreamingStats {
+/**
+Mean, standard deviation and quantiles of the samples of many nodes without
+storing the samples, so memory does not grow with their number. Mean and
+variance use Welford's update, every quantile the P-square algorithm of Jain
+and Chlamtac (1985), which keeps five markers per quantile and node. Until a
+node has five samples its quantiles come from the sorted samples.
+
+The samples of one node must be added by one thread at a time, different
+nodes may be updated in parallel.
+**/
+  int nQ;                   // Number of quantiles
+  QList<double> Prob;       // Probabilities of the quantiles
+  QVector<int> Count;       // Samples per node
+  QVector<double> Mean;
+  QVector<double> M2;       // Sum of squared deviations from the mean
+  QVector<double> Height;   // Markers of quantile q of node i at
+  QVector<int> Pos;         //   (i*nQ + q)*5 to (i*nQ + q)*5 + 4
+
+  void addMarkers(int m, double p, int n, double x);
+
+ public:
+  StreamingStats(int nodes, const QList<double> &quantiles);
+  void add(int i, double x);
+  int quantiles() const {return nQ;}
+  double probability(int q) const {return Prob[q];}
+  int count(int i) const {return Count[i];}
+  double mean(int i) const {return Mean[i];}
+  double std(int i) const {
+    return (Count[i] > 1) ? sqrt(M2[i]/(Count[i] - 1)) : 0;
+  }
+  double quantile(int i, int q) const;
+};
+
+#endif  // STREAMINGSTATS_H_
@@ -0,0 +1,91 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#ifndef CONVERTERS_H_
+#define CONVERTERS_H_
+
+#include <stddef.h>
+#include "DensityKernel.h"
+#include "ERMs.h"
+#include "libvelodt.h"
+#include "RockModel.h"
+#include "TemperatureSolver.h"
+
+class Converter {
+/**
+A conversion whose settings are checked and prepared once. convert() only
+reads the converter, so one converter serves any number of threads at once.
+The libvelodt functions build one per call, 'velodt serve' keeps them for
+later requests with the same settings. If status() is not VELODT_OK the
+settings were invalid and convert() returns that status.
+**/
+  Converter(const Converter &);
+  Converter &operator=(const Converter &);
+
+ protected:
+  velodt_status Status;             // Result of checking the settings
+  const EarthReferenceModel *ERM;   // Shared, see referenceModel()
+
+ public:
+  Converter() : Status(VELODT_OK), ERM(0) {}
+  virtual ~Converter() {}
+  velodt_status status() const {return Status;}
+  virtual int outputs() const = 0;  // Number of output columns
+  virtual velodt_status convert(size_t n, const double *z, const double *in,
+                                double *out0, double *out1) const = 0;
+
+  static const EarthReferenceModel *referenceModel(velodt_erm erm);
+  static const MineralSet *mineralSet(velodt_minerals minerals);
+};
+
+class V2TConverter : public Converter {
+  // Vs / km/s to T / degC
+  TemperatureSolver Kernel;
+  Calibration p;
+
+ public:
+  explicit V2TConverter(const v2t_config &cfg);
+  int outputs() const {return 1;}
+  velodt_status convert(size_t n, const double *z, const double *in,
+                        double *out0, double *out1) const;
+};
+
+class T2RhoConverter : public Converter {
+  // T / degC to rho / kg/m3
+  DensityKernel Kernel;
+
+ public:
+  explicit T2RhoConverter(const t2rho_config &cfg);
+  int outputs() const {return 1;}
+  velodt_status convert(size_t n, const double *z, const double *in,
+                        double *out0, double *out1) const;
+};
+
+class V2RhoTConverter : public Converter {
+  // V / m/s to T / degC and rho / kg/m3
+  RockModel *Model;
+  double T_start, Fdamp, threshold;
+
+ public:
+  explicit V2RhoTConverter(const v2rhot_config &cfg);
+  ~V2RhoTConverter();
+  int outputs() const {return 2;}
+  velodt_status convert(size_t n, const double *z, const double *in,
+                        double *out0, double *out1) const;
+};
+
+#endif  // CONVERTERS_H_
@@ -0,0 +1,118 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#ifndef LIBVELODT_H_
+#define LIBVELODT_H_
+
+/**
+Batch interface to the conversions of V2T, T2Rho and V2RhoT for use in other
+programs. All arrays are owned by the caller and are neither copied nor kept.
+The functions neither print nor exit, errors are returned as status codes.
+Every call only uses its own memory and the constant reference models, so the
+functions can be called from several threads at once.
+
+Units are those of the tools: depth z in m (the sign is ignored), Vs in km/s
+for v2t_convert(), V in m/s for v2rhot_convert(), temperatures in degC and
+densities in kg/m3. Each *_config_init() sets the defaults of the tool.
+**/
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  VELODT_OK = 0,               // All points converted
+  VELODT_INVALID_ARGUMENT,     // Null pointer, unknown or invalid setting
+  VELODT_INVALID_COMPOSITION,  // Phase fractions do not sum up to 1
+  VELODT_NOT_CONVERGED         // Points without result are set to NaN
+} velodt_status;
+
+typedef enum {
+  VELODT_AK135 = 0,
+  VELODT_PREM
+} velodt_erm;
+
+typedef enum {
+  VELODT_GOES = 0,             // Goes et al. (2000)
+  VELODT_CAMMARANO             // Cammarano et al. (2003)
+} velodt_minerals;
+
+typedef struct {
+  velodt_erm erm;              // Reference model for the pressure
+  double bV, m, c, A, E, Va;   // Priestley and McKenzie (2006), see V2T
+  double threshold;            // Iteration stops below this step / degC, > 0
+  int newton;                  // 1 = plain Newton instead of Halley
+} v2t_config;
+
+typedef struct {
+  velodt_erm erm;
+  velodt_minerals minerals;
+  double composition[5];       // Fractions of Ol, Opx, Cpx, Sp and Gnt
+  double XFe;                  // Iron content / mole fraction
+  int alphaT;                  // 1 = temperature dependent expansion
+} t2rho_config;
+
+typedef struct {
+  velodt_erm erm;
+  velodt_minerals minerals;
+  double composition[5];       // Fractions of Ol, Opx, Cpx, Sp and Gnt
+  double XFe;                  // Iron content / mole fraction
+  int alphaT;                  // 1 = temperature dependent expansion
+  char wave;                   // 'S' or 'P'
+  double frequency;            // Hz, 0 = default of the wave type
+  double threshold;            // Iteration stops below this step / K, > 0
+  double damping;              // Factor of the Newton step, (0, 1]
+  double T_start;              // Start of the iteration / K, > 0
+} v2rhot_config;
+
+void v2t_config_init(v2t_config *cfg);
+void t2rho_config_init(t2rho_config *cfg);
+void v2rhot_config_init(v2rhot_config *cfg);
+
+velodt_status v2t_convert(const double *z, const double *Vs, size_t n,
+                          double *T, const v2t_config *cfg);
+velodt_status t2rho_convert(const double *z, const double *T, size_t n,
+                            double *rho, const t2rho_config *cfg);
+velodt_status v2rhot_convert(const double *z, const double *V, size_t n,
+                             double *T, double *rho,
+                             const v2rhot_config *cfg);
+const char *velodt_status_string(velodt_status status);
+
+#ifdef __cplusplus
+}
+
+inline velodt_status v2t_convert(const double *z, const double *Vs, size_t n,
+                                 double *T, const v2t_config &cfg) {
+  return v2t_convert(z, Vs, n, T, &cfg);
+}
+
+inline velodt_status t2rho_convert(const double *z, const double *T,
+                                   size_t n, double *rho,
+                                   const t2rho_config &cfg) {
+  return t2rho_convert(z, T, n, rho, &cfg);
+}
+
+inline velodt_status v2rhot_convert(const double *z, const double *V,
+                                    size_t n, double *T, double *rho,
+                                    const v2rhot_config &cfg) {
+  return v2rhot_convert(z, V, n, T, rho, &cfg);
+}
+#endif
+
+#endif  // LIBVELODT_H_
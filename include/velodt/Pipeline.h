@@ -0,0 +1,51 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#ifndef PIPELINE_H_
+#define PIPELINE_H_
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <iostream>
+#include <stdlib.h>
+#include "ANSIICodes.h"
+#include "T2Rho.h"
+#include "V2RhoT.h"
+#include "V2T.h"
+
+class Pipeline {
+/**
+Runs several conversion tools in one process. The first stage reads the input
+file, every following stage works on the columns of the previous one in
+memory, and only the last stage writes its output. The options are handed to
+every stage, each of which picks the ones it knows.
+**/
+  enum Stage {StageV2T, StageT2Rho, StageV2RhoT};
+  QList<Stage> Stages;
+  QString Chain;          // Stages as given on the command line
+
+  bool setStages(QString chain);
+
+ public:
+  void usage();
+  void readArgs(int &argc, char *argv[]);
+  void run(int &argc, char *argv[]);
+};
+
+#endif  // PIPELINE_H_
@@ -0,0 +1,80 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#ifndef SERVER_H_
+#define SERVER_H_
+
+#include <QByteArray>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <iostream>
+#include <stdlib.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "ANSIICodes.h"
+#include "Converters.h"
+
+class Server {
+/**
+Converts points sent over a Unix domain socket, so that scripts with many
+small conversions do not pay for starting a tool each time. Converters are
+kept by their settings; the reference models, mineral properties and the
+dRho/dT table are set up once per process. Each thread of the pool accepts
+and serves one connection at a time.
+
+A connection carries any number of requests, each answered before the next
+one is read. All values are in host byte order:
+
+  request   int32 op, int32 nParams, int64 n, double params[nParams],
+            double z[n], double in[n]
+  response  int32 status, int32 nOut, int64 n, double out[nOut][n]
+
+op is one of the Op values. The params replace the defaults of the libvelodt
+configuration in the order given by paramNames(), missing ones keep their
+default. status is a velodt_status, units are those of libvelodt.h.
+**/
+  enum Op {OpPing = 0, OpV2T = 1, OpT2Rho = 2, OpV2RhoT = 3};
+  static const int MaxCache = 256;     // Converters kept at most
+  static const qint64 MaxPoints = 10000000;  // Points per request
+
+  QString Socket;         // Path of the socket
+  int Threads;            // Connections served at once, 0 = all cores
+  int Listen;             // Listening socket
+  QMap<QByteArray, Converter *> Cache;
+
+  static QStringList paramNames(int op);
+  Converter *build(int op, const QVector<double> &params);
+  const Converter *converter(int op, const QVector<double> &params,
+                             Converter *&own);
+  bool serve(int fd);
+  static bool receiveAll(int fd, void *buf, size_t len);
+  static bool sendAll(int fd, const void *buf, size_t len);
+  int threads();
+
+ public:
+  Server();
+  ~Server();
+  void usage();
+  void argsError(QString val, bool ok);
+  void readArgs(int &argc, char *argv[]);
+  void run(int &argc, char *argv[]);
+};
+
+#endif  // SERVER_H_
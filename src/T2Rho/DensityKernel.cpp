@@ -0,0 +1,88 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#include "DensityKernel.h"
+
+DensityKernel::DensityKernel() {
+  // Density 0 until prepare() is called
+  k_n = 0;
+  k_rho0 = 0;
+  for (int j=0; j < 4; j++)
+    k_rhoAlpha[j] = 0;
+}
+
+void DensityKernel::prepare(const MineralSet &DB, const double comp[5],
+                            double XFe, bool AlphaT) {
+  /**
+  * Collects everything in the density of the rock that does not depend on
+  * P and T. For every phase i with fraction c_i
+  *
+  *   rho_i = rho0_i*(1 - alpha_i*dT + dP/K_T) + drhodX_i*XFe
+  *   K_T   = K_i + dT*dKdT_i + dP*(dKdP_i + XFe*dKdPdX_i)
+  *
+  * so that the sum over the phases becomes k_rho0 - alpha*dT plus one term
+  * dP/K_T per phase. With AlphaT, alpha_i = alpha0 + alpha1*T + alpha2/T +
+  * alpha3/T^2, so the weighted sum of the four coefficients is stored in
+  * k_rhoAlpha. Phases that are not present are left out.
+  **/
+  k_n = 0;
+  k_rho0 = 0;
+  for (int j=0; j < 4; j++)
+    k_rhoAlpha[j] = 0;
+  for (int i=0; i < 5; i++) {
+    if (comp[i] == 0)
+      continue;
+    double rho = comp[i]*DB.rho[i];
+    k_rho0 += comp[i]*(DB.rho[i] + DB.drhodX[i]*XFe);
+    k_rhoAlpha[0] += rho*DB.alpha0[i];
+    if (AlphaT) {
+      k_rhoAlpha[1] += rho*DB.alpha1[i];
+      k_rhoAlpha[2] += rho*DB.alpha2[i];
+      k_rhoAlpha[3] += rho*DB.alpha3[i];
+    }
+    k_rho[k_n] = rho;
+    k_K[k_n] = DB.K[i];
+    k_dKdT[k_n] = DB.dKdT[i];
+    k_dKdP[k_n] = DB.dKdP[i] + XFe*DB.dKdPdX[i];
+    k_n++;
+  }
+}
+
+void DensityKernel::densities(int n, const double *P, const double *T,
+                              double *rho) const {
+  /**
+  * Density of the rock for n points with pressure P [Pa] and temperature T,
+  * using the constants from prepare(). The loop over the points is
+  * vectorised. Alpha(T) is evaluated in K from T in degC.
+  **/
+  const double T0 = 293.5;  // Reference temperature
+  const double P0 = 0;      // Reference pressure
+  const double c_K = 273.15;
+#ifdef _OPENMP
+  #pragma omp simd
+#endif
+  for (int k=0; k < n; k++) {
+    double dT = T[k] - T0;
+    double dP = P[k] - P0;
+    double TK = T[k] + c_K;
+    double r = k_rho0 - (k_rhoAlpha[0] + k_rhoAlpha[1]*TK + k_rhoAlpha[2]/TK
+                         + k_rhoAlpha[3]/TK/TK)*dT;
+    for (int i=0; i < k_n; i++)
+      r += k_rho[i]*dP/(k_K[i] + dT*k_dKdT[i] + dP*k_dKdP[i]);
+    rho[k] = r;
+  }
+}
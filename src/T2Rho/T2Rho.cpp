@@ -23,55 +23,14 @@ using std::endl;
 T2Rho::T2Rho() {
   PMethod = "AK135";
   ERM = new EarthReferenceModel(PMethod);
+  for (int i=0; i < 6; i++)
+    NcSlab[i] = -1;
+  Threads = 0;
+  data = &Own;
 
-  // Mineral properties Tab. A1 in Goes et al (2000)
-  m_rho.append(3222);
-  m_rho.append(3198);
-  m_rho.append(3280);
-  m_rho.append(3578);
-  m_rho.append(3565);
-
-  m_drhodX.append(1182);
-  m_drhodX.append(804);
-  m_drhodX.append(377);
-  m_drhodX.append(702);
-  m_drhodX.append(758);
-
-  m_K.append(1.29E+11);
-  m_K.append(1.11E+11);
-  m_K.append(1.05E+11);
-  m_K.append(1.98E+11);
-  m_K.append(1.73E+11);
-
-  m_dKdT.append(-1.60E+07);
-  m_dKdT.append(-1.20E+07);
-  m_dKdT.append(-1.30E+07);
-  m_dKdT.append(-2.80E+07);
-  m_dKdT.append(-2.10E+07);
-
-  m_dKdP.append(4.2);
-  m_dKdP.append(6);
-  m_dKdP.append(6.2);
-  m_dKdP.append(5.7);
-  m_dKdP.append(4.9);
-
-  m_dKdPdX.append(0);
-  m_dKdPdX.append(0);
-  m_dKdPdX.append(-1.9);
-  m_dKdPdX.append(0);
-  m_dKdPdX.append(0);
-
-  m_dKdX.append(0);
-  m_dKdX.append(-10E9);
-  m_dKdX.append(13E9);
-  m_dKdX.append(12E9);
-  m_dKdX.append(7E9);
-
-  m_alpha0.append(2.01E-5);
-  m_alpha0.append(3.871E-5);
-  m_alpha0.append(3.206E-5);
-  m_alpha0.append(6.969E-5);
-  m_alpha0.append(9.91E-6);
+  // Mineral properties Tab. A1 in Goes et al (2000), constant alpha
+  DB = &MineralDB::Goes;
+  AlphaT = false;
 
   // Initiate rock properties
   r_XFe = 0.1;
@@ -109,6 +68,15 @@ void T2Rho::usage() {
       << "                          2 - Off-cratonic (Shapiro and Ritzwoller, 2004)" << endl
       << "                          3 - Oceanic (Shapiro and Ritzwoller, 2004)" << endl
       << "  -xfe      val       0.1 Define iron content of the rock in mole fraction" << endl
+      << "  -minDB    1 or 2      2 Mineral property database by" << endl
+      << "                          1 - Cammarano et al. (2003)" << endl
+      << "                          2 - Goes et al. (2000)" << endl
+      << "  -AlphaT                 Activates T-dependency of alpha. Default" << endl
+      << "                          is constant alpha." << endl
+      << "  -ncvar    name          Variable in NetCDF input, default: first 3D" << endl
+      << "  -slab     i0 i1 j0 j1 k0 k1" << endl
+      << "                          Read only this index range from NetCDF input" << endl
+      << "  -threads  val         0 Number of threads, 0 = all cores" << endl
       << endl;
   exit(0);
 }
@@ -227,6 +195,34 @@ void T2Rho::readArgs(int &argc, char *argv[]) {
         int compp = arg[i+1].toInt(&ok);
         argsError(arg[i], ok);
         setComp(compp);
+      } else if (arg[i] == "-ncvar") {
+        argsError(arg[i], i + 1 < argc);
+        NcVar = arg[i+1];
+        i++;
+      } else if (arg[i] == "-slab") {
+        argsError(arg[i], i + 6 < argc);
+        for (int j=1; j < 7; j++) {
+          NcSlab[j-1] = arg[i+j].toInt(&ok);
+          argsError(arg[i+j], ok);
+        }
+        i += 6;
+      } else if (arg[i] == "-minDB") {
+        int DBarg = arg[i+1].toInt(&ok);
+        argsError(arg[i], ok);
+        if (DBarg == 1) {
+          DB = &MineralDB::Cammarano;
+        } else if (DBarg == 2) {
+          DB = &MineralDB::Goes;
+        } else {
+          argsError(arg[i], false);
+        }
+        i++;
+      } else if (arg[i] == "-AlphaT") {
+        AlphaT = true;
+      } else if (arg[i] == "-threads") {
+        Threads = arg[i+1].toInt(&ok);
+        argsError(arg[i], ok && Threads >= 0);
+        i++;
       }
     }
   }
@@ -246,32 +242,52 @@ void T2Rho::info() {
     cout << r_comp[i] << " ";
   cout << endl
        << "Iron content XFe: " << r_XFe << endl
+       << "Mineral properties: " << DB->Name << endl
+       << "Alpha: " << (AlphaT ? "Alpha(T)" : "Constant") << endl
        << "Earth reference model: " << ERM->type().toUtf8().data() << endl
        << endl;
 }
 
+int T2Rho::threads() {
+  // Number of threads used by calcDensity()
+#ifdef _OPENMP
+  return (Threads > 0) ? Threads : omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
 void T2Rho::readFile() {
   /**
-  * Basically everything happens in this function. This function reads the
-  * input file and directly computes the density. The result is written into
-  * the list data_out.
+  * Reads the input file into data->
   **/
-  double x, y, z, T, P;
+  double x, y, z, T;
   bool okx, oky, okz, okT;
-  double T0 = 293.5;  // Reference temperature
-  double P0 = 0;      // Reference pressure
   QRegExp separator("(\\s)");
 
+  if (NetCDFGrid::isNetCDF(file_in)) {
+    readNetCDF();
+    return;
+  }
+
   cout << "Reading file: " << file_in.toUtf8().data() << endl;
-  QFile file(file_in);
+  DataFile file(file_in);
 
   if (file.open(QIODevice::ReadOnly)) {
-    QTextStream stream(&file);
+    QTextStream stream(file.device());
 
     while (!stream.atEnd()) {
       QString t = stream.readLine().simplified();
 
-      if (!t.startsWith("#")) {
+      if (t.startsWith("# Grid_size:") && data->size() == 0) {
+        // Output of V2T on a regular grid, reserve memory for all points
+        QStringList gridSize = t.mid(12).split("x", QString::SkipEmptyParts);
+        int nx = gridSize.value(0).toInt(&okx);
+        int ny = gridSize.value(1).toInt(&oky);
+        int nz = gridSize.value(2).toInt(&okz);
+        if (okx && oky && okz)
+          data->setGrid(nx, ny, nz);
+      } else if (!t.isEmpty() && !t.startsWith("#")) {
         QStringList vals = t.split(separator);
         if (vals.count() != 4) {
           file.close();
@@ -284,27 +300,94 @@ void T2Rho::readFile() {
         y = vals[1].toDouble(&oky);
         z = vals[2].toDouble(&okz);
         T = vals[3].toDouble(&okT);
-        // Directly compute density
-        P = ERM->pressure(z+1);
-        // Compute phase properties and density
-        double rho_avrg = 0;
-        for (int i=0; i < 5; i++) {
-          double dT = T - T0;
-          double dP = P - P0;
-          double m_K_PX = m_dKdP[i] + r_XFe*m_dKdPdX[i];
-          double K_T = m_K[i] + dT*m_dKdT[i] + dP*m_K_PX;
-          double rho_PTX = m_rho[i]*(1 - m_alpha0[i]*dT + dP/K_T)
-          + m_drhodX[i]*r_XFe;
-          rho_avrg += r_comp[i]*rho_PTX;
-        }
-        // Add result to output data list
-        data_out.append(Point5D(x, y, z, T, rho_avrg));
+        if (data->size() == 0 && !data->isRegular())
+          data->reserve(DataFile::countRows(file_in));
+        data->append(x, y, z, Dataset::T, T);
         }
       }
     }
   }
 }
 
+void T2Rho::calcDensity() {
+  /**
+  * Computes the density of every point. The points are split into blocks
+  * that are distributed over the threads. For each block the pressures are
+  * looked up first, then the density kernel runs over the whole block.
+  **/
+  const int block = 1024;  // Points per call of densities()
+  int n = data->size();
+  data->allocate();
+  double comp[5];
+  for (int i=0; i < 5; i++)
+    comp[i] = r_comp[i];
+  Kernel.prepare(*DB, comp, r_XFe, AlphaT);
+  const double *T = data->column(Dataset::T);
+  double *Rho = data->column(Dataset::Rho);
+#ifdef _OPENMP
+  #pragma omp parallel for num_threads(threads())
+#endif
+  for (int k0=0; k0 < n; k0 += block) {
+    int m = qMin(block, n - k0);
+    double P[block];
+    for (int k=0; k < m; k++)
+      P[k] = ERM->pressure(data->z(k0 + k) + 1);
+    Kernel.densities(m, P, T + k0, Rho + k0);
+  }
+}
+
+void T2Rho::readNetCDF() {
+  /**
+  * Reads the temperature volume from a NetCDF file. Nodes with missing values
+  * are skipped.
+  **/
+  NetCDFGrid grid;
+
+  cout << "Reading file: " << file_in.toUtf8().data() << endl;
+  grid.setSlab(NcSlab[0], NcSlab[1], NcSlab[2], NcSlab[3], NcSlab[4],
+               NcSlab[5]);
+  if (!grid.read(file_in, NcVar)) {
+    cout << PRINT_ERROR "In " << file_in.toUtf8().data() << ": "
+         << grid.error().toUtf8().data() << endl;
+    exit(1);
+  }
+  data->setGrid(grid.nX(), grid.nY(), grid.nZ());
+  for (int n=0; n < grid.size(); n++) {
+    double T = grid.value(n);
+    if (!std::isnan(T))
+      data->append(grid.x(n), grid.y(n), grid.z(n), Dataset::T, T);
+  }
+}
+
+void T2Rho::writeNetCDF(QString header) {
+  NetCDFGrid grid;
+  QVector<double> x, y, z;
+  QList<NetCDFVariable> vars;
+  NetCDFVariable T, Rho;
+
+  T.name = "T";
+  T.long_name = "Temperature";
+  T.units = "degC";
+  Rho.name = "Rho";
+  Rho.long_name = "Density";
+  Rho.units = "kg/m3";
+  for (int i=0; i < data->size(); i++) {
+    x.append(data->x(i));
+    y.append(data->y(i));
+    z.append(data->z(i));
+  }
+  T.vals = data->column(Dataset::T);
+  Rho.vals = data->column(Dataset::Rho);
+  vars << T << Rho;
+
+  cout << "Writing output file " << file_out.toUtf8().data() << endl;
+  if (!grid.write(file_out, x, y, z, vars, header.remove("# "))) {
+    cout << PRINT_ERROR "Could not write " << file_out.toUtf8().data() << ": "
+         << grid.error().toUtf8().data() << endl;
+    exit(1);
+  }
+}
+
 void T2Rho::writeFile() {
   QString header;
   // Get timestamp
@@ -322,6 +405,12 @@ void T2Rho::writeFile() {
   header += QString("# Sp - %1\n").arg(r_comp[3], 5, 'f', 2);
   header += QString("# Gnt - %1\n").arg(r_comp[4], 5, 'f', 2);
   header += QString("# Iron content XFe: %1\n").arg(r_XFe, 3, 'f', 2);
+  header += QString("# Mineral properties: %1\n").arg(DB->Name);
+  header += QString("# Alpha: %1\n").arg(AlphaT ? "Alpha(T)" : "Constant");
+  if (NetCDFGrid::isNetCDF(file_out)) {
+    writeNetCDF(header);
+    return;
+  }
   header += QString("# Point data\n"
                     "# Columns:\n"
                     "# 1 - X\n"
@@ -332,36 +421,28 @@ void T2Rho::writeFile() {
 
   cout << "Writing output file " << file_out.toUtf8().data() << endl;
 
-  QFile tmp(file_out);
+  DataFile tmp(file_out);
   if (!tmp.open(QIODevice::WriteOnly | QIODevice::Text)) {
     cout << PRINT_ERROR "Could not open file " << file_out.toUtf8().data()
          << endl;
     exit(1);
   }
 
-  QTextStream out(&tmp);
+  QTextStream out(tmp.device());
   out.setRealNumberPrecision(2);
   out.setFieldAlignment(QTextStream::AlignRight);
   out.setRealNumberNotation(QTextStream::FixedNotation);
   out << header.toUtf8().data();
-  for (int i=0; i < data_out.length(); i++) {
-    out << data_out[i][0] << "\t"
-        << data_out[i][1] << "\t"
-        << data_out[i][2] << "\t"
-        << data_out[i][3] << "\t"
-        << data_out[i][4] << "\n";
+  const double *T = data->column(Dataset::T);
+  const double *Rho = data->column(Dataset::Rho);
+  for (int i=0; i < data->size(); i++) {
+    out << data->x(i) << "\t"
+        << data->y(i) << "\t"
+        << data->z(i) << "\t"
+        << T[i] << "\t"
+        << Rho[i] << "\n";
   }
-  tmp.close();
+  out.flush();
+  if (!tmp.close())
+    exit(1);
 }
-
-int main(int argc, char *argv[]) {
-  T2Rho converter;
-  if (argc > 0) {
-    converter.readArgs(argc, argv);
-    converter.info();
-    converter.readFile();
-    converter.writeFile();
-  } else {
-    converter.usage();
-  }
-}
\ No newline at end of file
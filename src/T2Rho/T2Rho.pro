@@ -19,11 +19,21 @@ TEMPLATE = app
 DESTDIR = ../../bin
 TARGET = T2Rho
 CONFIG -= app_bundle
+CONFIG += c++11
 
 INCLUDEPATH += ../../include/common ../../include/T2Rho
 
 LIBS += -L../common -lcommon
+netcdf {
+  LIBS += -lnetcdf
+}
+# OpenMP parallelises the conversion, disable with 'qmake CONFIG+=no_openmp'
+!no_openmp {
+  QMAKE_CXXFLAGS += -fopenmp
+  QMAKE_LFLAGS += -fopenmp
+}
 
-SOURCES += T2Rho.cpp
+SOURCES += main.cpp T2Rho.cpp DensityKernel.cpp
 
-HEADERS += ../../include/T2Rho/T2Rho.h
+HEADERS += ../../include/T2Rho/T2Rho.h \
+           ../../include/T2Rho/DensityKernel.h
@@ -0,0 +1,41 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#include "T2Rho.h"
+
+using std::cout;
+using std::endl;
+
+int main(int argc, char *argv[]) {
+  T2Rho converter;
+  QElapsedTimer timer;
+  qint64 t_read, t_calc;
+  if (argc > 0) {
+    converter.readArgs(argc, argv);
+    converter.info();
+    timer.start();
+    converter.readFile();
+    t_read = timer.restart();
+    converter.calcDensity();
+    t_calc = timer.restart();
+    converter.writeFile();
+    cout << "Run time / s: reading " << t_read/1000.0 << ", conversion "
+         << t_calc/1000.0 << ", writing " << timer.elapsed()/1000.0 << endl;
+  } else {
+    converter.usage();
+  }
+}
\ No newline at end of file
@@ -0,0 +1,155 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#include "JointInversion.h"
+
+JointInversion::JointInversion(const RockModel &p, const RockModel &s,
+                               const RockParameter &unknown) {
+  Base[0] = &p;
+  Base[1] = &s;
+  Unknown = unknown;
+  None.kind = RockParameter::None;
+  None.phase = -1;
+  for (int i=0; i < 5; i++)
+    Comp[i] = p.composition(i);
+  XFe = p.xfe();
+  MaxSteps = 200;
+}
+
+double JointInversion::initial() const {
+  // Value of the unknown in the base rock
+  if (Unknown.kind == RockParameter::XFe)
+    return XFe;
+  return Comp[Unknown.phase];
+}
+
+void JointInversion::rock(double c, double comp[5], double &xfe) const {
+  // Composition and iron content at the value c of the unknown
+  int k = Unknown.phase;
+  xfe = XFe;
+  for (int i=0; i < 5; i++)
+    comp[i] = Comp[i];
+  if (Unknown.kind == RockParameter::XFe) {
+    xfe = c;
+    return;
+  }
+  for (int i=0; i < 5; i++)
+    comp[i] = (i == k) ? c : Comp[i]*(1. - c)/(1. - Comp[k]);
+}
+
+double JointInversion::misfit(const RockModel *m[2], double Vp, double Vs,
+                              double P, double T,
+                              RockProperties props[2]) const {
+  // RMS misfit / m/s of both velocities, props receives the properties
+  props[0] = m[0]->evaluate(P, T);
+  props[1] = m[1]->evaluate(P, T);
+  return sqrt((pow(Vp - props[0].V, 2) + pow(Vs - props[1].V, 2))/2.);
+}
+
+bool JointInversion::invert(double Vp, double Vs, double P, double T_start,
+                            double c_start, double threshold,
+                            double c_threshold, JointResult &r) const {
+  /**
+  Newton iteration for the temperature / K and the unknown c at which the
+  synthetic velocities at pressure P equal Vp and Vs, starting at T_start
+  and c_start. Stops when the Newton step of T and c is below threshold and
+  c_threshold. While c is at a bound that the step would cross, c is kept
+  and only T is fitted to both velocities (Gauss-Newton). If no fraction of
+  the step reduces the misfit or after MaxSteps steps, T is set to 272.15 K
+  and false is returned.
+  **/
+  double V[2] = {Vp, Vs};
+  double comp[5], xfe;
+  double T = T_start;
+  double c = qBound(0., c_start, 1.);
+  RockProperties props[2], trial[2];
+  rock(c, comp, xfe);
+  RockModel m_p(*Base[0], comp, xfe), m_s(*Base[1], comp, xfe);
+  const RockModel *m[2] = {&m_p, &m_s};
+  double f = misfit(m, Vp, Vs, P, T, props);
+  bool ok = false;
+
+  r.steps = 0;
+  while (!ok && r.steps < MaxSteps) {
+    r.steps++;
+    // Analytic Jacobian d(V_p, V_s)/d(T, c)
+    double J[2][2], res[2];
+    for (int w=0; w < 2; w++) {
+      J[w][0] = m[w]->velocity(m[w]->coefficients<Dual>(None), P,
+                               Dual(T, 1.)).d;
+      J[w][1] = m[w]->velocity(m[w]->coefficients<Dual>(Unknown), P,
+                               Dual(T)).d;
+      res[w] = V[w] - props[w].V;
+    }
+    double det = J[0][0]*J[1][1] - J[0][1]*J[1][0];
+    double JJ = J[0][0]*J[0][0] + J[1][0]*J[1][0];
+    bool at_bound = (c <= 0 || c >= 1);
+    bool fixed_c = (det == 0 || !std::isfinite(det));
+    bool reduced = false;
+
+    // Newton step for T and c, at a bound that the step would cross or
+    // that it can not leave with a lower misfit the least squares fit of
+    // both velocities with T only
+    for (int pass=0; pass < 2 && !reduced && !ok; pass++) {
+      double dT, dc = 0;
+      if (!fixed_c) {
+        dT = (res[0]*J[1][1] - J[0][1]*res[1])/det;
+        dc = (J[0][0]*res[1] - J[1][0]*res[0])/det;
+        fixed_c = (c <= 0 && dc < 0) || (c >= 1 && dc > 0);
+      }
+      if (fixed_c) {
+        if (JJ == 0 || !std::isfinite(JJ))
+          break;
+        dT = (J[0][0]*res[0] + J[1][0]*res[1])/JJ;
+        dc = 0;
+      }
+      if (fabs(dT) < threshold && fabs(dc) < c_threshold)
+        ok = true;
+
+      // Halve the step until the misfit does not increase
+      double lambda = 1;
+      for (int h=0; h < 20 && !reduced; h++, lambda /= 2) {
+        double T_new = T + lambda*dT;
+        double c_new = qBound(0., c + lambda*dc, 1.);
+        rock(c_new, comp, xfe);
+        m_p = RockModel(*Base[0], comp, xfe);
+        m_s = RockModel(*Base[1], comp, xfe);
+        double f_new = misfit(m, Vp, Vs, P, T_new, trial);
+        if (f_new <= f) {
+          reduced = true;
+          T = T_new;
+          c = c_new;
+          f = f_new;
+          props[0] = trial[0];
+          props[1] = trial[1];
+        }
+      }
+      if (!at_bound || fixed_c)
+        break;
+      fixed_c = true;
+    }
+    // Unless converged, a step that does not reduce the misfit at all is a
+    // failure and not a small step
+    if (!reduced && !ok)
+      break;
+  }
+  r.T = ok ? T : 272.15;
+  r.c = c;
+  r.rho = props[0].rho;
+  r.misfit = f;
+  return ok;
+}
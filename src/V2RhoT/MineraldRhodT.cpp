@@ -24,11 +24,6 @@ MineraldRhodT::MineraldRhodT() {
   AlphaMode = 0;
   Tmin = 273.;
   Tmax = 2273.;
-  set_alpha(0, 0.0000201, 0.00003871, 0.00003206, 0.00006969, 0.00000991);
-  set_alpha(1, 0.0000000139, 0.00000000446, 0.00000000811, -0.00000000108,
-            0.00000001165);
-  set_alpha(2, 0.001627, 0.000343, 0.001347, -0.030799, 0.010624);
-  set_alpha(3, -0.338, -1.7278, -1.8167, 5.0395, -2.5);
   fill();
 }
 
@@ -52,37 +47,6 @@ bool MineraldRhodT::set_AlphaMode(int mode) {
   }
 }
 
-void MineraldRhodT::set_alpha(int idx, double Ol, double Opx, double Cpx,
-                              double Sp, double Gnt) {
-  if (idx == 0) {
-    alpha0.append(Ol);
-    alpha0.append(Opx);
-    alpha0.append(Cpx);
-    alpha0.append(Sp);
-    alpha0.append(Gnt);
-  } else if (idx == 1) {
-    alpha1.append(Ol);
-    alpha1.append(Opx);
-    alpha1.append(Cpx);
-    alpha1.append(Sp);
-    alpha1.append(Gnt);
-  } else if (idx == 2) {
-    alpha2.append(Ol);
-    alpha2.append(Opx);
-    alpha2.append(Cpx);
-    alpha2.append(Sp);
-    alpha2.append(Gnt);
-  } else if (idx == 3) {
-    alpha3.append(Ol);
-    alpha3.append(Opx);
-    alpha3.append(Cpx);
-    alpha3.append(Sp);
-    alpha3.append(Gnt);
-  } else {
-    cout << PRINT_ERROR "set_alpha() wrong idx\n";
-  }
-}
-
 void MineraldRhodT::fill() {
   /**
   Calculates dRhodT for T from Tmin to Tmax in steps of 1K
@@ -107,13 +71,10 @@ void MineraldRhodT::fill() {
 
   // Fill values for every mineral after Goes et al (2000)
   // Initial values are for T=0degC=273K
-  Rho_i0.append(3222.0);  //Ol
-  Rho_i0.append(3198.0);  //Opx
-  Rho_i0.append(3280.0);  //Cpx
-  Rho_i0.append(3578.0);  //Sp
-  Rho_i0.append(3565.0);  //Gnt
+  const MineralSet &DB = MineralDB::Goes;
 
   for (int i=0; i < 5; i++) {
+    Rho_i0.append(DB.rho[i]);
     Rho_i1.append(0.);
     alpha_i.append(0.);
     dRhodT_i.append(0.);
@@ -128,10 +89,9 @@ void MineraldRhodT::fill() {
 
     for (int j=0; j < 5; j++) {
       if (AlphaMode == 0) {
-        alpha_i[j] = alpha0[j];
+        alpha_i[j] = DB.alpha0[j];
       } else if (AlphaMode == 1) {
-        alpha_i[j] = alpha0[j] + alpha1[j]*T_i + alpha2[j]/T_i
-                     + alpha3[j]/T_i/T_i;
+        alpha_i[j] = DB.alpha(j, T_i);
       }
       Rho_i1[j] = Rho_i0[j]/(1. + alpha_i[j]*dT);
       vals_T[j+1] = (Rho_i1[j] - Rho_i0[j])/dT;
@@ -141,7 +101,7 @@ void MineraldRhodT::fill() {
   }
 }
 
-double MineraldRhodT::dRhodT(double T, int mineral) {
+double MineraldRhodT::dRhodT(double T, int mineral) const {
   /**
   Returns dRho/dT at T. T must be in Kelvin!
   If T lies between two stored T-values, dRho/dT will be interpolated linearly
@@ -151,27 +111,28 @@ double MineraldRhodT::dRhodT(double T, int mineral) {
    2 - Cpx
    3 - Sp
    4 - Gnt
+  Outside the table 999 is returned, see covers().
   **/
 
   int T_low;
   double dRdT_low, dRdT_high;
 
-  if (T < Tmin || T > Tmax) {
-    cout << PRINT_WARNING "Iteration failed. Temperature out of bounds T="
-         << T << " K\n";
+  if (!covers(T)) {
     return 999;
   } else if (fmod(T, 1) == 0 && T < 2273.0) {
     // If temperature is already in table
     return vals[static_cast<int>(T) - 273][mineral+1];
   } else {
     T_low = static_cast<int>(T - fmod(T, 1) - 273);
+    if (T_low + 1 >= vals.size())  // Between the last entry and Tmax
+      return vals.last()[mineral+1];
     dRdT_low = vals[T_low][mineral+1];
     dRdT_high = vals[T_low+1][mineral+1];
     return (T - static_cast<double>(T_low))*(dRdT_high - dRdT_low) + dRdT_low;
   }
 }
 
-void MineraldRhodT::exportTable() {
+void MineraldRhodT::exportTable() const {
   QString OutName = "dRhodT.txt";
   QString T_header = QString("# T / K\tOl / kg/m3/K\tOpx / kg/m3/K\tCpx / "
                              "kg/m3/K\tSp / kg/m3/K\tGnt / kg/m3/K");
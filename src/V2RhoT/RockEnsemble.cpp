@@ -0,0 +1,137 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#define _USE_MATH_DEFINES
+#include "RockEnsemble.h"
+
+namespace {
+
+class Random {
+  // SplitMix64 stream with normal numbers by the Box-Muller transform
+  quint64 State;
+  double Spare;
+  bool HasSpare;
+
+ public:
+  explicit Random(quint64 seed) : State(seed), Spare(0), HasSpare(false) {}
+  quint64 next() {
+    quint64 z = (State += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+  double uniform() {
+    // In (0, 1]
+    return ((next() >> 11) + 1)*(1.0/9007199254740992.0);
+  }
+  double normal() {
+    if (HasSpare) {
+      HasSpare = false;
+      return Spare;
+    }
+    double r = sqrt(-2.*log(uniform()));
+    double phi = 2.*M_PI*uniform();
+    Spare = r*sin(phi);
+    HasSpare = true;
+    return r*cos(phi);
+  }
+};
+
+}  // namespace
+
+RockEnsemble::RockEnsemble(const MineralSet &db, const QModel &q,
+                           const RockUncertainty &sigma, quint64 seed) {
+  BaseSet = db;
+  BaseQ = q;
+  Sigma = sigma;
+  Seed = seed;
+}
+
+RockUncertainty RockEnsemble::defaults() {
+  /**
+  Rough estimates in the range discussed by Goes et al. (2000) and Cammarano
+  et al. (2003). They should be set for the study with -mcsd.
+  **/
+  RockUncertainty s;
+  s.K = 0.01;
+  s.dKdT = 0.1;
+  s.dKdP = 0.05;
+  s.mu = 0.01;
+  s.dmudT = 0.1;
+  s.dmudP = 0.05;
+  s.alpha = 0.1;
+  s.a = 0.1;
+  s.A = 0.2;
+  s.H = 0.05;
+  s.V = 0.2;
+  return s;
+}
+
+bool RockEnsemble::setSigma(RockUncertainty &sigma, QString name, double val) {
+  // False for an unknown parameter name or a negative deviation
+  if (val < 0)
+    return false;
+  if (name == "K")
+    sigma.K = val;
+  else if (name == "dKdT")
+    sigma.dKdT = val;
+  else if (name == "dKdP")
+    sigma.dKdP = val;
+  else if (name == "mu")
+    sigma.mu = val;
+  else if (name == "dmudT")
+    sigma.dmudT = val;
+  else if (name == "dmudP")
+    sigma.dmudP = val;
+  else if (name == "alpha")
+    sigma.alpha = val;
+  else if (name == "a")
+    sigma.a = val;
+  else if (name == "A")
+    sigma.A = val;
+  else if (name == "H")
+    sigma.H = val;
+  else if (name == "V")
+    sigma.V = val;
+  else
+    return false;
+  return true;
+}
+
+void RockEnsemble::realization(int r, MineralSet &db, QModel &q) const {
+  // Perturbed copies of the mineral properties and anelasticity parameters
+  Random rnd(Seed ^ (0xD1B54A32D192ED03ULL*(static_cast<quint64>(r) + 1)));
+  db = BaseSet;
+  for (int i=0; i < 5; i++) {
+    db.K[i] *= 1 + Sigma.K*rnd.normal();
+    db.dKdT[i] *= 1 + Sigma.dKdT*rnd.normal();
+    db.dKdP[i] *= 1 + Sigma.dKdP*rnd.normal();
+    db.mu[i] *= 1 + Sigma.mu*rnd.normal();
+    db.dmudT[i] *= 1 + Sigma.dmudT*rnd.normal();
+    db.dmudP[i] *= 1 + Sigma.dmudP*rnd.normal();
+    double f = 1 + Sigma.alpha*rnd.normal();
+    db.alpha0[i] *= f;
+    db.alpha1[i] *= f;
+    db.alpha2[i] *= f;
+    db.alpha3[i] *= f;
+  }
+  q = BaseQ;
+  q.a *= 1 + Sigma.a*rnd.normal();
+  q.A *= 1 + Sigma.A*rnd.normal();
+  q.H *= 1 + Sigma.H*rnd.normal();
+  q.V *= 1 + Sigma.V*rnd.normal();
+}
@@ -0,0 +1,333 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#define _USE_MATH_DEFINES
+#include "RockModel.h"
+
+namespace {
+
+template <typename S>
+S scaled(double val, bool seeded) {
+  // val, with Dual the derivative by a factor val is multiplied with
+  S s = val;
+  if (seeded)
+    seed(s, val);
+  return s;
+}
+
+}  // namespace
+
+bool RockParameter::parse(QString name, RockParameter &p) {
+  /**
+  Parameter by its name in -sens: K, dKdT, dKdP, mu, dmudT, dmudP or alpha
+  for all phases, followed by _Ol, _Opx, _Cpx, _Sp or _Gnt for one phase,
+  a, A, H or V of Q, a phase name for its fraction, or XFe. False if unknown.
+  **/
+  static const char *phases[5] = {"Ol", "Opx", "Cpx", "Sp", "Gnt"};
+  static const char *minerals[7] = {"K", "dKdT", "dKdP", "mu", "dmudT",
+                                    "dmudP", "alpha"};
+  static const char *anelastic[4] = {"a", "A", "H", "V"};
+  QString base = name;
+  p.kind = None;
+  p.phase = -1;
+  int split = name.indexOf("_");
+  if (split >= 0) {
+    base = name.left(split);
+    for (int i=0; i < 5; i++) {
+      if (name.mid(split + 1) == phases[i])
+        p.phase = i;
+    }
+    if (p.phase < 0)
+      return false;
+  }
+  for (int k=0; k < 7; k++) {
+    if (base == minerals[k])
+      p.kind = static_cast<Kind>(K + k);
+  }
+  if (split >= 0)
+    return p.kind != None;
+  for (int k=0; k < 4; k++) {
+    if (base == anelastic[k])
+      p.kind = static_cast<Kind>(a + k);
+  }
+  for (int i=0; i < 5; i++) {
+    if (base == phases[i]) {
+      p.kind = Comp;
+      p.phase = i;
+    }
+  }
+  if (base == "XFe")
+    p.kind = XFe;
+  return p.kind != None;
+}
+
+RockModel::RockModel(const MineralSet &db, const double comp[5], double xfe,
+                     bool alphaT, const QModel &q, double frequency,
+                     QString VelType, double t0, double p0) {
+  DB = &db;
+  for (int i=0; i < 5; i++)
+    Comp[i] = comp[i];
+  XFe = xfe;
+  AlphaT = alphaT;
+  SWave = (VelType == "S");
+  Q = q;
+  Frequency = frequency;
+  T0 = t0;
+  P0 = p0;
+  build();
+}
+
+RockModel::RockModel(const RockModel &base, const double comp[5],
+                     double xfe) {
+  // Model with the settings of base and another composition
+  *this = base;
+  for (int i=0; i < 5; i++)
+    Comp[i] = comp[i];
+  XFe = xfe;
+  build();
+}
+
+void RockModel::build() {
+  // Coefficients of the property chain
+  RockParameter none = {RockParameter::None, -1};
+  C = coefficients<double>(none);
+
+  // P/T independent part of Eqn A5b
+  anh_sum1 = 0.;
+  if (SWave) {
+    for (int i=0; i < 5; i++)
+      anh_sum1 = anh_sum1 + Comp[i]*DB->dmudT[i];
+  } else {
+    for (int i=0; i < 5; i++)
+      anh_sum1 = anh_sum1 + Comp[i]*(DB->dKdT[i] + 4.0/3.0*DB->dmudT[i]);
+  }
+}
+
+const MineraldRhodT &RockModel::table() {
+  // Filled once on first use, read-only afterwards
+  static const MineraldRhodT dRhodT;
+  return dRhodT;
+}
+
+template <typename S>
+RockCoefficients<S> RockModel::coefficients(const RockParameter &p) const {
+  /**
+  Inputs of state(). With Dual numbers the derivatives are seeded for the
+  parameter p. Mineral and anelasticity parameters are multiplied by a common
+  factor, so their derivatives are per relative change, d/dln(p). The
+  fraction of a phase is changed while the other phases are rescaled to keep
+  the sum at 1. XFe is changed by its mole fraction.
+  **/
+  typedef RockParameter R;
+  RockCoefficients<S> c;
+  S xfe = XFe;
+  if (p.kind == R::XFe)
+    seed(xfe, 1.);
+  for (int i=0; i < 5; i++) {
+    bool phase = p.phase < 0 || p.phase == i;
+    c.Comp[i] = Comp[i];
+    if (p.kind == R::Comp) {
+      if (i == p.phase)
+        seed(c.Comp[i], 1.);
+      else if (Comp[p.phase] < 1.)
+        seed(c.Comp[i], -Comp[i]/(1. - Comp[p.phase]));
+    }
+
+    // Mineral density including iron content
+    c.rhoXFe[i] = DB->rho[i] + DB->drhodX[i]*xfe;
+    c.K[i] = scaled<S>(DB->K[i], p.kind == R::K && phase);
+    c.dKdT[i] = scaled<S>(DB->dKdT[i], p.kind == R::dKdT && phase);
+    c.dKdP[i] = scaled<S>(DB->dKdP[i], p.kind == R::dKdP && phase)
+                + xfe*DB->dKdPdX[i];
+    c.KXFe[i] = xfe*DB->dKdX[i];
+    c.mu[i] = scaled<S>(DB->mu[i], p.kind == R::mu && phase);
+    c.dmudT[i] = scaled<S>(DB->dmudT[i], p.kind == R::dmudT && phase);
+    c.dmudP[i] = scaled<S>(DB->dmudP[i], p.kind == R::dmudP && phase);
+    c.muXFe[i] = xfe*DB->dmudX[i];
+    bool alpha = p.kind == R::alpha && phase;
+    c.alpha[0][i] = scaled<S>(DB->alpha0[i], alpha);
+    c.alpha[1][i] = scaled<S>(DB->alpha1[i], alpha);
+    c.alpha[2][i] = scaled<S>(DB->alpha2[i], alpha);
+    c.alpha[3][i] = scaled<S>(DB->alpha3[i], alpha);
+  }
+
+  c.Qa = scaled<S>(Q.a, p.kind == R::a);
+  c.QH = scaled<S>(Q.H, p.kind == R::H);
+  c.QV = scaled<S>(Q.V, p.kind == R::V);
+  c.QPrefactor = scaled<S>(Q.A, p.kind == R::A)*pow(2.*M_PI*Frequency, c.Qa);
+  c.tanQ = tan(M_PI*c.Qa/2.);
+  return c;
+}
+
+template <typename S>
+RockState<S> RockModel::state(const RockCoefficients<S> &c, S P, S T) const {
+  /**
+  Density, moduli, quality factors and velocity at pressure P / Pa and
+  temperature T / K. Moduli and density are Voigt-Reuss-Hill averages of the
+  phases.
+  **/
+  RockState<S> r;
+  S alpha[5];
+  S voigt, reuss;
+
+  // Thermal expansion
+  for (int i=0; i < 5; i++) {
+    alpha[i] = AlphaT ? c.alpha[0][i] + c.alpha[1][i]*T + c.alpha[2][i]/T
+                        + c.alpha[3][i]/T/T
+                      : c.alpha[0][i];
+  }
+
+  // <K>
+  voigt = 0.0;
+  reuss = 0.0;
+  for (int i=0; i < 5; i++) {
+    r.K_i[i] = c.K[i] + (T - T0)*c.dKdT[i] + (P - P0)*c.dKdP[i] + c.KXFe[i];
+    voigt = voigt + c.Comp[i]*r.K_i[i];
+    reuss = reuss + c.Comp[i]/r.K_i[i];
+  }
+  r.K = (voigt + 1./reuss)/2.;
+
+  // <rho>
+  r.rho = 0.0;
+  for (int i=0; i < 5; i++)
+    r.rho = r.rho + c.Comp[i]*(c.rhoXFe[i]*(1. - alpha[i]*(T - T0)
+                               + (P - P0)/r.K_i[i]));
+
+  // <mu>
+  voigt = 0.0;
+  reuss = 0.0;
+  for (int i=0; i < 5; i++) {
+    r.mu_i[i] = c.mu[i] + (T - T0)*c.dmudT[i] + (P - P0)*c.dmudP[i]
+                + c.muXFe[i];
+    voigt = voigt + c.Comp[i]*r.mu_i[i];
+    reuss = reuss + c.Comp[i]/r.mu_i[i];
+  }
+  r.mu = (voigt + 1./reuss)/2.;
+
+  // Q_mu and Q_P, Eqns A6 and A7
+  r.Qmu = c.QPrefactor*exp(c.Qa*(c.QH + P*c.QV)/c_R/T);
+  r.QP = SWave ? S(0) : r.Qmu/(4.*r.mu/(3.*r.K + 4.*r.mu));
+
+  // Synthetic velocity, Eqn A8
+  if (SWave)
+    r.V = sqrt(r.mu/r.rho)*(1. - 2./r.Qmu/c.tanQ);
+  else
+    r.V = sqrt((r.K + 4./3*r.mu)/r.rho)*(1. - 2./r.QP/c.tanQ);
+  return r;
+}
+
+template RockCoefficients<double> RockModel::coefficients(
+    const RockParameter &p) const;
+template RockCoefficients<Dual> RockModel::coefficients(
+    const RockParameter &p) const;
+
+RockProperties RockModel::evaluate(double P, double T) const {
+  // All rock properties at pressure P / Pa and temperature T / K
+  RockProperties r;
+  RockState<double> s = state(C, P, T);
+  r.T = T;
+  r.P = P;
+  r.rho = s.rho;
+  r.K = s.K;
+  r.mu = s.mu;
+  r.Qmu = s.Qmu;
+  r.QP = s.QP;
+  r.V = s.V;
+
+  // Anharmonic d<mu>/dT or d<M>/dT, Eqn A5b
+  if (SWave) {
+    r.dMdT = anh_sum1;
+  } else {
+    double M_reuss = 0.0, anh_sum2 = 0.0;
+    for (int i=0; i < 5; i++) {
+      M_reuss = M_reuss + Comp[i]/(s.K_i[i] + 4.0/3.0*s.mu_i[i]);
+      anh_sum2 = anh_sum2 + (Comp[i]/(s.K_i[i] + 4./3*s.mu_i[i])*(DB->dKdT[i]
+                             + 4./3*DB->dmudT[i]));
+    }
+    M_reuss = 1./M_reuss;
+    r.dMdT = anh_sum1 + pow(M_reuss, -2)*anh_sum2;
+  }
+
+  // drho/dT
+  const MineraldRhodT &dRhodT = table();
+  r.inTable = dRhodT.covers(T);
+  r.drhodT = 0.;
+  for (int i=0; i < 5; i++)
+    r.drhodT = r.drhodT + Comp[i]*dRhodT.dRhodT(T, i);
+
+  // dV/dT, Eqns A9 (anelastic) and A4 (anharmonic)
+  double Qeff = SWave ? r.Qmu : r.QP;
+  r.dVdT = Q.A*Q.H/Qeff/2./c_R/T/T/C.tanQ
+           + (r.dMdT - pow(r.V, 2)*r.drhodT)/(2.*r.rho*r.V);
+  return r;
+}
+
+Dual RockModel::velocity(const RockCoefficients<Dual> &c, double P,
+                          Dual T) const {
+  // Synthetic velocity and its derivative along the seeded parameter and T
+  return state(c, Dual(P), T).V;
+}
+
+void RockModel::sensitivities(double P, double T,
+                              const RockCoefficients<Dual> *params, int n,
+                              double *dT, double *dRho) const {
+  /**
+  Sensitivities of a converted point to the n parameters seeded in params,
+  T / K being the temperature at which the synthetic velocity matches the
+  observed one at pressure P. As V stays at the observed velocity, the
+  implicit function theorem gives dT/dp = -(dV/dp)/(dV/dT). Both derivatives
+  are taken of state(), dVdT of evaluate() only approximates dV/dT. The
+  density changes by drho/dp + drho/dT*dT/dp.
+  **/
+  RockParameter none = {RockParameter::None, -1};
+  RockState<Dual> t = state(coefficients<Dual>(none), Dual(P), Dual(T, 1.));
+  for (int k=0; k < n; k++) {
+    RockState<Dual> s = state(params[k], Dual(P), Dual(T));
+    dT[k] = -s.V.d/t.V.d;
+    dRho[k] = s.rho.d + t.rho.d*dT[k];
+  }
+}
+
+bool RockModel::invert(double V, double P, double T_start, double Fdamp,
+                       double threshold, double &T, int &steps,
+                       RockProperties &props) const {
+  /**
+  Damped Newton iteration for the temperature T / K at which the synthetic
+  velocity at pressure P equals V, starting at T_start. Stops when a step is
+  below threshold. After 10000 steps T is set to 272.15 K and false is
+  returned. props holds the properties of the last step.
+  **/
+  double deltaT, T_n, T_n1;
+
+  T_n = T_start;    // Temperature at step n
+  T_n1 = 0.;        // Temperature at step n+1
+  steps = 0;
+  deltaT = threshold + 1;
+  while (deltaT > threshold) {
+    props = evaluate(P, T_n);
+    T_n1 = T_n + Fdamp*(V - props.V)/props.dVdT;
+    deltaT = fabs(T_n - T_n1);
+    steps++;
+    if (steps > 10000) {
+      T = 272.15;
+      return false;
+    }
+    T_n = T_n1;
+  }
+  T = T_n1;
+  return true;
+}
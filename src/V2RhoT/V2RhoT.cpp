@@ -25,12 +25,20 @@ using std::endl;
 
 const QString compilationTime = QString("%1 %2").arg(__DATE__).arg(__TIME__);
 
+namespace {
+
+bool samePosition(double a, double b) {
+  // Coordinates of two files agree within rounding
+  return fabs(a - b) <= 1e-6*(1. + fabs(a));
+}
+
+}  // namespace
+
 V2RhoT::V2RhoT() {
   ArbitraryPoints = false;
   use_t_crust = false;
   verbose = false;
   petrel = false;
-  count_avrg = 0;
   c_Fdamp = 0.025;
   scaleZ = 1.;
   scaleVs = 1.;
@@ -42,11 +50,25 @@ V2RhoT::V2RhoT() {
   threshold = 0.1;
 
   T_start = 273.15;
+  for (int i=0; i < 6; i++)
+    NcSlab[i] = -1;
+  Order = Dataset::FileOrder;
+  CustomFreq = -1.;
+  Threads = 0;
+  CheckpointInterval = 0;
+  Resume = false;
+  Incremental = false;
+  MCRealizations = 0;
+  MCSeed = 1;
+  MCSigma = RockEnsemble::defaults();
+  MCQuantiles << 0.05 << 0.5 << 0.95;
   MantleRock = new Rock;
   ERM = new EarthReferenceModel;
 }
 
 V2RhoT::~V2RhoT() {
+  for (int k=1; k < Jobs.size(); k++)
+    delete Jobs[k].MantleRock;
   delete MantleRock;
   delete ERM;
 }
@@ -78,8 +100,13 @@ void V2RhoT::Info() {
   cout << endl
        << "Output\n"
        << "------\n"
-       << "Temperatures       : " << File_Out.toUtf8().data() << "\n"
-       << endl;
+       << "Temperatures       : " << File_Out.toUtf8().data() << "\n";
+  if (Jobs.size() > 1) {
+  cout << "Jobs               : " << File_jobs.toUtf8().data() << "\n";
+  for (int k=1; k < Jobs.size(); k++)
+  cout << "                     " << Jobs[k].FileOut.toUtf8().data() << "\n";
+  }
+  cout << endl;
   if (use_t_crust) {
   cout << "Densities\n"
        << "---------\n"
@@ -112,7 +139,20 @@ void V2RhoT::Info() {
        << "z-scaling factor  : " << scaleZ << endl
        << "V-scaling factor  : " << scaleVs << endl
        << "Dampening         : " << c_Fdamp << endl
-       << endl;
+       << "Threads           : " << threads() << endl;
+  if (!File_joint.isEmpty())
+  cout << "Joint inversion   : V" << (VelType == "P" ? "S" : "P") << " from "
+       << File_joint.toUtf8().data() << ", solving for T and "
+       << JointName.toUtf8().data() << endl;
+  if (!SensNames.isEmpty())
+  cout << "Sensitivities     : " << SensNames.join(", ").toUtf8().data() << endl;
+  if (MCRealizations > 0)
+  cout << "Monte Carlo       : " << MCRealizations << " realizations, seed "
+       << MCSeed << endl;
+  if (CheckpointInterval > 0)
+  cout << "Checkpoint        : " << checkpointFile().toUtf8().data() << ", every "
+       << CheckpointInterval << " s" << (Resume ? ", resume" : "") << endl;
+  cout << endl;
 }
 
 void V2RhoT::usage() {
@@ -142,6 +182,8 @@ void V2RhoT::help() {
        << "  ------    ----- ------- -----------\n"
        << "  -AlphaT                 Activates T-dependency of alpha. Default\n"
        << "                          is constant alpha.\n"
+       << "  -checkpoint val         Write completed results to File_Out.ckpt\n"
+       << "                          every val seconds, see -resume\n"
        << "  -compc    vals          Custom rock composition, see example 2\n"
        << "                          -comp Ol Opx Cpx Sp Gnt\n"
        << "  -compp    val         0 Use predefined rock compositions:\n"
@@ -153,21 +195,56 @@ void V2RhoT::help() {
        << "  -ERM      string  AK135 P calculation method AK135, PREM or simple\n"
        << "  -f        val    1/0.02 Define custom wave frequency in Hz.\n"
        << "  -fdamp    val     0.025 Iteration dampening\n"
+       << "  -incremental            Convert only points whose velocity, pressure\n"
+       << "                          or settings changed since the last run, see\n"
+       << "                          File_Out.chunks\n"
+       << "  -joint    path name     Joint inversion with the velocities of the\n"
+       << "                          other wave type in path (same points) for\n"
+       << "                          T and name: Ol, Opx, Cpx, Sp, Gnt (fraction,\n"
+       << "                          others rescaled) or XFe\n"
+       << "  -jobs     path          Further rock configurations, one per line:\n"
+       << "                          FileOut followed by rock options, see\n"
+       << "                          example 3. The input is read only once.\n"
+       << "  -mc       val           Monte Carlo uncertainty propagation with val\n"
+       << "                          realizations of the mineral properties and\n"
+       << "                          anelasticity, writes mean, standard\n"
+       << "                          deviation and quantiles of T and Rho\n"
+       << "  -mcq      vals 0.05,0.5,0.95\n"
+       << "                          Comma separated probabilities of quantiles\n"
+       << "  -mcsd     name val      Relative standard deviation of a parameter:\n"
+       << "                          K 0.01, dKdT 0.1, dKdP 0.05, mu 0.01,\n"
+       << "                          dmudT 0.1, dmudP 0.05, alpha 0.1 (per\n"
+       << "                          phase), a 0.1, A 0.2, H 0.05, V 0.2 (Q)\n"
        << "  -minDB    1 or 2      1 Mineral property database by\n"
        << "                          1 - Cammarano et al. (2003)\n"
        << "                          2 - Goes et al. (2000)\n"
+       << "  -ncvar    name          Variable in NetCDF input, default: first 3D\n"
+       << "  -order    string   file Order of processing the points, file or\n"
+       << "                          morton (Z-order curve, spatially coherent)\n"
        << "  -petrel                 Output is written as Petrel Points with  Attribtues\n"
        << "  -prop                   Print mineral properties\n"
        << "  -Q        1 or 2      1 Anelasticity paramters Q\n"
        << "                          1 - Sobolev et al. (1996)\n"
        << "                          2 - Berckhemer et al. (1982)\n"
+       << "  -resume                 Continue from the checkpoint of an interrupted\n"
+       << "                          run with the same options. Checkpoints are\n"
+       << "                          written every 300 s unless -checkpoint is set\n"
        << "  -rc       val      2890 Crustal density in kg/m3\n"
        << "  -rm       val      3300 Mantle density in kg/m3\n"
        << "  -ra       val      3100 Average density in kg/m3 used in '-ERM simple'\n"
        << "  -scaleZ   val         1 Scale every z-value in File_In by this value\n"
        << "  -scaleV   val         1 Scale every Vs-value in File_In by this value\n"
        << "  -scatter                Use scattered data as input instead of regular grid\n"
+       << "  -seed     val         1 Random seed of the Monte Carlo realizations\n"
+       << "  -sens     names         Comma separated parameters to write dT/dp\n"
+       << "                          and dRho/dp for: K, dKdT, dKdP, mu, dmudT,\n"
+       << "                          dmudP, alpha (all phases or e.g. K_Gnt),\n"
+       << "                          a, A, H, V (Q) per relative change,\n"
+       << "                          Ol, Opx, Cpx, Sp, Gnt (fraction) and XFe\n"
+       << "  -slab     i0 i1 j0 j1 k0 k1\n"
+       << "                          Read only this index range from NetCDF input\n"
        << "  -t        val       0.1 Threshold in K where Temperature iteration stops\n"
+       << "  -threads  val         0 Number of threads, 0 = all cores\n"
        << "  -Tstart   val    273.15 Iteration starting temperature\n"
        << "  -t_crust  path          EarthVision file for crustal thickness\n"
        << "  -writedRdT              Writes used dRho/dT tables for minerals to a text file\n"
@@ -179,6 +256,14 @@ void V2RhoT::help() {
        << endl
        << "Example 2:\n"
        << "V2RhoT Vs.dat T.dat -type S -compc 0.82 0.144 0.0 0.0 0.036\n"
+       << endl
+       << "Example 3:\n"
+       << "V2RhoT Vs.dat T.dat -type S -jobs jobs.txt\n"
+       << "with jobs.txt containing the lines\n"
+       << "T_cratonic.dat -compp 1\n"
+       << "T_oceanic.dat -compp 3 -xfe 0.1 -Q 2\n"
+       << "Rock options of the command line apply to all jobs, the options\n"
+       << "-AlphaT, -compc, -compp, -f, -minDB, -Q and -xfe are accepted.\n"
        << endl;
   exit(0);
 }
@@ -190,20 +275,77 @@ void V2RhoT::argsError(QString val, bool ok) {
   }
 }
 
+int V2RhoT::rockArg(Rock *rock, const QStringList &arg, int i,
+                    double &freq) {
+  /**
+  Applies the rock option arg[i] and its values to rock. A frequency given by
+  -f is returned in freq. Returns the number of values that were consumed,
+  -1 if arg[i] is not a rock option. Used for the command line and for the
+  lines of the -jobs file.
+  **/
+  bool ok;
+  int n;
+  if (arg[i] == "-AlphaT")
+    n = 0;
+  else if (arg[i] == "-compc")
+    n = 5;
+  else if (arg[i] == "-compp" || arg[i] == "-f" || arg[i] == "-minDB"
+           || arg[i] == "-Q" || arg[i] == "-xfe")
+    n = 1;
+  else
+    return -1;
+  argsError(arg[i], i + n < arg.size());
+
+  if (arg[i] == "-AlphaT") {
+    rock->set_AlphaMode(1);
+  } else if (arg[i] == "-compc") {
+    double comp[5];
+    for (int j=0; j < 5; j++) {
+      comp[j] = arg[i+j+1].toDouble(&ok);
+      argsError(arg[i+j+1], ok);
+    }
+    rock->set_Comp(comp[0], comp[1], comp[2], comp[3], comp[4]);
+  } else if (arg[i] == "-compp") {
+    int comp = arg[i+1].toInt(&ok);
+    argsError(arg[i+1], ok);
+    rock->set_Comp(comp);
+  } else if (arg[i] == "-f") {
+    freq = arg[i+1].toDouble(&ok);
+    argsError(arg[i], ok);
+  } else if (arg[i] == "-minDB") {
+    int DBarg = arg[i+1].toInt(&ok);
+    argsError(arg[i], ok);
+    if (DBarg == 1) {
+      ok = rock->set_MineralPropertyDB("Cammarano");
+    } else if (DBarg == 2) {
+      ok = rock->set_MineralPropertyDB("Goes");
+    }
+    argsError(arg[i], ok);
+  } else if (arg[i] == "-Q") {
+    int Qarg = arg[i+1].toInt(&ok);
+    argsError(arg[i], ok);
+    ok = rock->setQ(Qarg);
+    argsError(arg[i], ok);
+  } else if (arg[i] == "-xfe") {
+    double ArgXFe = arg[i+1].toDouble(&ok);
+    argsError(arg[i], ok);
+    ok = rock->set_XFe(ArgXFe);
+    argsError(arg[i], ok);
+  }
+  return n;
+}
+
 void V2RhoT::readArgs(int &argc, char *argv[]) {
   /**
   Input convention
   V2RhoT FileIn FileOut -rc val -rm val -ra val -t_crust path -z_topo path
   -v -t val
   **/
-  bool ok, okCrust, okTopo, UseCustomOmega, definedPMethod;
-  double CustomFreq = -1.;
-  QList <double> comp_input;
+  bool ok, okCrust, okTopo, definedPMethod;
 
   ok = false;
   okCrust = false;
   okTopo = false;
-  UseCustomOmega = false;
   definedPMethod = false;
 
   QStringList arg;
@@ -234,7 +376,12 @@ void V2RhoT::readArgs(int &argc, char *argv[]) {
     File_Out = arg[2].toUtf8().data();
 
     for (int i=3; i < argc; i++) {
-      if (arg[i] == "-type") {
+      int used = rockArg(MantleRock, arg, i, CustomFreq);
+      if (used >= 0) {
+        // Remembered as the defaults of the jobs in File_jobs
+        RockArgs << arg.mid(i, used + 1);
+        i += used;
+      } else if (arg[i] == "-type") {
         if (arg[i+1] == "P" || arg[i+1] == "S") {
           VelType = arg[i+1];
           i++;
@@ -242,52 +389,71 @@ void V2RhoT::readArgs(int &argc, char *argv[]) {
           ok = false;
           argsError(arg[i], ok);
         }
-      } else if (arg[i] == "-AlphaT") {
-        MantleRock->set_AlphaMode(1);
-      } else if (arg[i] == "-compc") {
-        for (int j=1; j < 6; j++) {
-          comp_input.append(arg[i+j].toDouble(&ok));
-          argsError(arg[i+j], ok);
-        }
-        MantleRock->set_Comp(comp_input[0], comp_input[1], comp_input[2],
-                             comp_input[3], comp_input[4]);
-        i+=5;
-      } else if (arg[i] == "-compp") {
-        MantleRock->set_Comp(arg[i+1].toDouble(&ok));
-        argsError(arg[i+1], ok);
+      } else if (arg[i] == "-checkpoint") {
+        argsError(arg[i], i + 1 < argc);
+        CheckpointInterval = arg[i+1].toDouble(&ok);
+        argsError(arg[i], ok && CheckpointInterval >= 0);
         i++;
       } else if (arg[i] == "-ERM") {
         ok = SetPMethod(arg[i+1]);
         argsError(arg[i], ok);
         definedPMethod = true;
         i++;
-      } else if (arg[i] == "-f") {
-        UseCustomOmega = true;
-        CustomFreq = arg[i+1].toDouble(&ok);
-        argsError(arg[i], ok);
-        i++;
       } else if (arg[i] == "-fdamp") {
         c_Fdamp = arg[i+1].toDouble(&ok);
         argsError(arg[i], ok);
         i++;
-      } else if (arg[i] == "-minDB") {
-        int DBarg = arg[i+1].toInt(&ok);
-        argsError(arg[i], ok);
-        if (DBarg == 1) {
-          ok = MantleRock->set_MineralPropertyDB("Cammarano");
-        } else if (DBarg == 2) {
-          ok = MantleRock->set_MineralPropertyDB("Goes");
+      } else if (arg[i] == "-incremental") {
+        Incremental = true;
+      } else if (arg[i] == "-jobs") {
+        argsError(arg[i], i + 1 < argc);
+        File_jobs = arg[i+1];
+        i++;
+      } else if (arg[i] == "-joint") {
+        argsError(arg[i], i + 2 < argc);
+        File_joint = arg[i+1];
+        JointName = arg[i+2];
+        argsError(arg[i], RockParameter::parse(JointName, JointParam)
+                          && (JointParam.kind == RockParameter::Comp
+                              || JointParam.kind == RockParameter::XFe));
+        i+=2;
+      } else if (arg[i] == "-mc") {
+        argsError(arg[i], i + 1 < argc);
+        MCRealizations = arg[i+1].toInt(&ok);
+        argsError(arg[i], ok && MCRealizations > 0);
+        i++;
+      } else if (arg[i] == "-mcq") {
+        argsError(arg[i], i + 1 < argc);
+        MCQuantiles.clear();
+        QStringList vals = arg[i+1].split(",");
+        for (int j=0; j < vals.size(); j++) {
+          MCQuantiles << vals[j].toDouble(&ok);
+          argsError(arg[i], ok && MCQuantiles.last() > 0
+                            && MCQuantiles.last() < 1);
+        }
+        i++;
+      } else if (arg[i] == "-mcsd") {
+        argsError(arg[i], i + 2 < argc);
+        double sd = arg[i+2].toDouble(&ok);
+        argsError(arg[i], ok && RockEnsemble::setSigma(MCSigma, arg[i+1], sd));
+        i+=2;
+      } else if (arg[i] == "-ncvar") {
+        argsError(arg[i], i + 1 < argc);
+        NcVar = arg[i+1];
+        i++;
+      } else if (arg[i] == "-order") {
+        argsError(arg[i], i + 1 < argc);
+        if (arg[i+1] == "morton") {
+          Order = Dataset::Morton;
+        } else if (arg[i+1] != "file") {
+          ok = false;
+          argsError(arg[i], ok);
         }
-        argsError(arg[i], ok);
         i++;
       } else if (arg[i] == "-petrel") {
         petrel = true;
-      } else if (arg[i] == "-Q") {
-        int Qarg = arg[i+1].toInt(&ok);
-        argsError(arg[i], ok);
-        ok = MantleRock->setQ(Qarg);
-        argsError(arg[i], ok);
-        i++;
+      } else if (arg[i] == "-resume") {
+        Resume = true;
       } else if (arg[i] == "-rc") {
         rho_crust = arg[i+1].toDouble(&ok);
         argsError(arg[i], ok);
@@ -311,6 +477,25 @@ void V2RhoT::readArgs(int &argc, char *argv[]) {
         i++;
       } else if (arg[i] == "-scatter") {
         ArbitraryPoints = true;
+      } else if (arg[i] == "-seed") {
+        argsError(arg[i], i + 1 < argc);
+        MCSeed = arg[i+1].toULongLong(&ok);
+        argsError(arg[i], ok);
+        i++;
+      } else if (arg[i] == "-sens") {
+        argsError(arg[i], i + 1 < argc);
+        SensNames = arg[i+1].split(",");
+        SensParams.resize(SensNames.size());
+        for (int j=0; j < SensNames.size(); j++)
+          argsError(arg[i], RockParameter::parse(SensNames[j], SensParams[j]));
+        i++;
+      } else if (arg[i] == "-slab") {
+        argsError(arg[i], i + 6 < argc);
+        for (int j=1; j < 7; j++) {
+          NcSlab[j-1] = arg[i+j].toInt(&ok);
+          argsError(arg[i+j], ok);
+        }
+        i+=6;
       } else if (arg[i] == "-Tstart") {
         T_start = arg[i+1].toDouble(&ok);
         argsError(arg[i], ok);
@@ -325,15 +510,13 @@ void V2RhoT::readArgs(int &argc, char *argv[]) {
         threshold = arg[i+1].toDouble(&ok);
         argsError(arg[i], ok);
         i++;
+      } else if (arg[i] == "-threads") {
+        Threads = arg[i+1].toInt(&ok);
+        argsError(arg[i], ok && Threads >= 0);
+        i++;
       } else if (arg[i] == "-v") {
         verbose = true;
         MantleRock->setVerbose(verbose);
-      } else if (arg[i] == "-xfe") {
-        double ArgXFe = arg[i+1].toDouble(&ok);
-        argsError(arg[i], ok);
-        ok = MantleRock->set_XFe(ArgXFe);
-        argsError(arg[i], ok);
-        i++;
       } else if (arg[i] == "-z_topo") {
         File_z_topo = arg[i+1];
         okTopo = true;
@@ -345,6 +528,41 @@ void V2RhoT::readArgs(int &argc, char *argv[]) {
         exit(1);
       }
     }
+
+    // A checkpoint is only resumed with the same options
+    for (int i=1; i < argc; i++) {
+      if (arg[i] == "-checkpoint" || arg[i] == "-threads")
+        i++;
+      else if (arg[i] != "-resume" && arg[i] != "-v"
+               && arg[i] != "-incremental")
+        Settings += arg[i] + " ";
+    }
+    if (Resume && CheckpointInterval == 0)
+      CheckpointInterval = 300;
+  }
+  if (MCRealizations > 0
+      && (!File_jobs.isEmpty() || Incremental || CheckpointInterval > 0)) {
+    cout << PRINT_ERROR "-mc can not be combined with -jobs, -incremental, "
+         << "-checkpoint or -resume" << endl;
+    exit(1);
+  }
+  if (!SensParams.isEmpty() && (!File_jobs.isEmpty() || MCRealizations > 0)) {
+    cout << PRINT_ERROR "-sens can not be combined with -jobs or -mc" << endl;
+    exit(1);
+  }
+  if (!File_joint.isEmpty()) {
+    if (!File_jobs.isEmpty() || MCRealizations > 0 || !SensParams.isEmpty()
+        || Incremental || CheckpointInterval > 0) {
+      cout << PRINT_ERROR "-joint can not be combined with -jobs, -mc, -sens, "
+           << "-incremental, -checkpoint or -resume" << endl;
+      exit(1);
+    }
+    if (JointParam.kind == RockParameter::Comp
+        && MantleRock->getComposition(JointParam.phase) >= 1.) {
+      cout << PRINT_ERROR "-joint: the rock consists of "
+           << JointName.toUtf8().data() << " only" << endl;
+      exit(1);
+    }
   }
 
   // Some logic checks
@@ -375,13 +593,83 @@ void V2RhoT::readArgs(int &argc, char *argv[]) {
   }
 
   // Define Omega
-  if (UseCustomOmega) {
+  if (CustomFreq >= 0) {
     MantleRock->set_omega(CustomFreq);
   } else {
     // If no custom frequency given define omega according to Goes et al. (2000)
     // f_p = 1Hz or f_s = 0.02Hz
     MantleRock->set_omega(VelType);
   }
+
+  // The command line configuration is the first job
+  RockJob job = {File_Out, MantleRock, 0., 0};
+  Jobs.append(job);
+  if (!File_jobs.isEmpty())
+    readJobs(File_jobs);
+}
+
+void V2RhoT::readJobs(QString FileName) {
+  /**
+  Reads further rock configurations for -jobs. Every line holds the output
+  file name followed by rock options, lines starting with # are comments.
+  A job starts from the rock options of the command line, the options of its
+  line are applied on top.
+  **/
+  DataFile file(FileName);
+  if (!file.open(QIODevice::ReadOnly)) {
+    cout << PRINT_ERROR "File " << FileName.toUtf8().data() << " not found\n";
+    exit(1);
+  }
+  QTextStream stream(file.device());
+
+  int n = 0;
+  while (!stream.atEnd()) {
+    n++;
+    QString t = stream.readLine().simplified();
+    if (t.isEmpty() || t.startsWith("#"))
+      continue;
+    QStringList vals = t.split(" ");
+    if (vals[0].startsWith("-")) {
+      cout << PRINT_ERROR "In line " << n << " of " << FileName.toUtf8().data()
+           << ": output file name missing." << endl;
+      exit(1);
+    }
+    for (int k=0; k < Jobs.size(); k++) {
+      if (Jobs[k].FileOut == vals[0]) {
+        cout << PRINT_ERROR "In line " << n << " of "
+             << FileName.toUtf8().data() << ": output file "
+             << vals[0].toUtf8().data() << " used twice." << endl;
+        exit(1);
+      }
+    }
+
+    RockJob job = {vals[0], new Rock, 0., 0};
+    job.MantleRock->setVerbose(verbose);
+    double freq = -1.;
+    QStringList args = RockArgs + vals.mid(1);
+    for (int i=0; i < args.size(); i++) {
+      int used = rockArg(job.MantleRock, args, i, freq);
+      if (used < 0) {
+        cout << PRINT_ERROR "In line " << n << " of "
+             << FileName.toUtf8().data() << ": unknown rock option "
+             << args[i].toUtf8().data() << endl;
+        exit(1);
+      }
+      i += used;
+    }
+    if (freq >= 0)
+      job.MantleRock->set_omega(freq);
+    else
+      job.MantleRock->set_omega(VelType);
+    Jobs.append(job);
+    Settings += "\n" + t;
+  }
+  file.close();
+
+  if (Jobs.size() == 1) {
+    cout << PRINT_ERROR "No jobs in " << FileName.toUtf8().data() << endl;
+    exit(1);
+  }
 }
 
 bool V2RhoT::readFile(QString InName, QString InType) {
@@ -391,8 +679,11 @@ bool V2RhoT::readFile(QString InName, QString InType) {
 
   okGrid = false;  // Used to check if grid size was extracted from input voxel
 
+  if (InType == "vox" && NetCDFGrid::isNetCDF(InName))
+    return readNetCDF(InName);
+
   cout << "Reading file: " << InName.toUtf8().data() << endl;
-  QFile file(InName);
+  DataFile file(InName);
 
   x_min1 = 1.7E308;
   x_min2 = x_min1;
@@ -411,13 +702,15 @@ bool V2RhoT::readFile(QString InName, QString InType) {
 
   int n = 0;
   if (file.open(QIODevice::ReadOnly)) {
-  QTextStream stream(&file);
+  QTextStream stream(file.device());
 
   while (!stream.atEnd()) {
     n++;
     QString t = stream.readLine().simplified();
 
-    if (!t.startsWith("#") && (InType == "topo" || InType == "crust")) {
+    if (t.isEmpty()) {
+      continue;
+    } else if (!t.startsWith("#") && (InType == "topo" || InType == "crust")) {
       /// Topography or crustal thickness
       QStringList vals = t.split(" ");
       if (vals.count() != 6) {
@@ -479,6 +772,7 @@ bool V2RhoT::readFile(QString InName, QString InType) {
           exit(1);
         }
         okGrid = true;
+        data.setGrid(nX, nY, nZ);
       } else if (!t.startsWith("#") && InType == "vox") {
         QStringList vals = t.split(" ");
         if (vals.count() != 4) {
@@ -499,8 +793,9 @@ bool V2RhoT::readFile(QString InName, QString InType) {
                << endl;
           exit(1);
         } else if (okx && oky && okz && okval) {
-          Point5D p5D(x, y, z, val, 0.0);
-          data_V.append(p5D);
+          if (data.size() == 0 && !data.isRegular())
+            data.reserve(DataFile::countRows(InName));
+          data.append(x, y, z, Dataset::V, val);
         } else {
           file.close();
           cout << PRINT_ERROR "In value conversion line " << n << "\n";
@@ -533,14 +828,23 @@ bool V2RhoT::readFile(QString InName, QString InType) {
   }
 
   file.close();
+  if (InType == "crust")
+    CrustIndex.build(t_crust);
+  else if (InType == "topo")
+    TopoIndex.build(z_topo);
   return true;
   }
   cout << PRINT_ERROR "File " << InName.toUtf8().data() << " not found\n";
   exit(1);
 }
 
-bool V2RhoT::saveFile(QString OutName) {
+bool V2RhoT::saveFile(QString OutName, int job) {
+  // Writes the temperatures and densities of Jobs[job]
   QString T_header, Info_header, usecrust;
+  Rock *rock = Jobs[job].MantleRock;
+  QList<int> cols;
+  QStringList units, long_names;
+  QStringList names = extraColumns(cols, units, long_names);
 
   // Create time stamp
   QDateTime currentDateTime = QDateTime::currentDateTime();
@@ -555,28 +859,40 @@ bool V2RhoT::saveFile(QString OutName) {
   Info_header += QString("# Date created: %1\n").arg(timestamp);
   Info_header += QString("# Input file: %1\n").arg(File_In);
   Info_header += QString("# Mantle composition:\n");
-  Info_header += QString("# Ol - %1\n").arg(MantleRock->getComposition(0), 5, 'f', 2);
-  Info_header += QString("# Opx - %1\n").arg(MantleRock->getComposition(1), 5, 'f', 2);
-  Info_header += QString("# Cpx - %1\n").arg(MantleRock->getComposition(2), 5, 'f', 2);
-  Info_header += QString("# Sp - %1\n").arg(MantleRock->getComposition(3), 5, 'f', 2);
-  Info_header += QString("# Gnt - %1\n").arg(MantleRock->getComposition(4), 5, 'f', 2);
-  Info_header += QString("# Iron content XFe: %1\n").arg(MantleRock->getXFe(),3,'f',2);
+  Info_header += QString("# Ol - %1\n").arg(rock->getComposition(0), 5, 'f', 2);
+  Info_header += QString("# Opx - %1\n").arg(rock->getComposition(1), 5, 'f', 2);
+  Info_header += QString("# Cpx - %1\n").arg(rock->getComposition(2), 5, 'f', 2);
+  Info_header += QString("# Sp - %1\n").arg(rock->getComposition(3), 5, 'f', 2);
+  Info_header += QString("# Gnt - %1\n").arg(rock->getComposition(4), 5, 'f', 2);
+  Info_header += QString("# Iron content XFe: %1\n").arg(rock->getXFe(),3,'f',2);
   Info_header += QString("# Pressure calculation method: %1\n").arg(PMethod);
   if (use_t_crust) {
     Info_header += QString("# Use crustal thickness for pressure calculation: %1\n").arg(usecrust);
     Info_header += QString("# Density crust/mantle/average: %1%2%3\n")
       .arg(rho_crust, 7, 'f', 1).arg(rho_mantle, 7, 'f', 1).arg(rho_avrg, 7, 'f', 1);
   }
-  Info_header += QString("# Alpha: %1\n").arg(MantleRock->get_AlphaModeStr());
+  Info_header += QString("# Alpha: %1\n").arg(rock->get_AlphaModeStr());
   if (use_t_crust) {
     Info_header += QString("# Topography: %1\n").arg(File_z_topo);
     Info_header += QString("# Crustal thickness: %1\n").arg(File_t_crust);
   }
-  Info_header += QString("# Wave frequency / Hz: %1\n").arg(MantleRock->get_frequency());
+  Info_header += QString("# Wave frequency / Hz: %1\n").arg(rock->get_frequency());
   Info_header += QString("# Dampening factor: %1\n").arg(c_Fdamp);
   Info_header += QString("# Iteration starting temperature / K: %1\n").arg(T_start);
-  Info_header += QString("# Anelasticity parameters: %1\n").arg(MantleRock->getQ());
-  Info_header += QString("# Average iteration steps: %1\n").arg(count_avrg,0,'f',1);
+  Info_header += QString("# Anelasticity parameters: %1\n").arg(rock->getQ());
+  if (!File_joint.isEmpty()) {
+    Info_header += QString("# Joint inversion: V%1 from %2, unknown %3\n")
+                     .arg(VelType == "P" ? "S" : "P").arg(File_joint)
+                     .arg(JointName);
+  }
+  if (MCRealizations > 0) {
+    Info_header += QString("# Monte Carlo realizations: %1, seed %2\n")
+                     .arg(MCRealizations).arg(MCSeed);
+  }
+  Info_header += QString("# Average iteration steps: %1\n").arg(Jobs[job].count_avrg,0,'f',1);
+
+  if (NetCDFGrid::isNetCDF(OutName))
+    return saveNetCDF(OutName, Info_header, job);
 
   if (petrel) {
     T_header  = QString("# Petrel Points with attributes\n");
@@ -591,6 +907,10 @@ bool V2RhoT::saveFile(QString OutName) {
     T_header += QString("FLOAT,V%1 / km/s\n").arg(VelType);
     T_header += QString("FLOAT,T / degC\n");
     T_header += QString("FLOAT,Rho / kg/m3\n");
+    for (int k=0; k < names.size(); k++) {
+      T_header += QString("FLOAT,%1 / %2\n").arg(names[k])
+                    .arg(units[k]);
+    }
     T_header += QString("END HEADER");
   } else if (ArbitraryPoints) {
     T_header  =  QString("# Point data\n");
@@ -602,6 +922,10 @@ bool V2RhoT::saveFile(QString OutName) {
     T_header += QString("# 4 - V_%1 / m/s\n").arg(VelType);
     T_header += QString("# 5 - T / degC\n");
     T_header += QString("# 6 - Rho / kg/m3");
+    for (int k=0; k < names.size(); k++) {
+      T_header += QString("\n# %1 - %2 / %3").arg(k + 7).arg(names[k])
+                    .arg(units[k]);
+    }
   } else {
     T_header  = QString("# Type: GMS GridPoints\n");
     T_header += QString("# Version: 2\n");
@@ -613,6 +937,10 @@ bool V2RhoT::saveFile(QString OutName) {
     T_header += QString("# Field: 4 V_%1 / m/s\n").arg(VelType);
     T_header += QString("# Field: 5 T / degC\n");
     T_header += QString("# Field: 6 Rho / kg/m3\n");
+    for (int k=0; k < names.size(); k++) {
+      T_header += QString("# Field: %1 %2 / %3\n").arg(k + 7).arg(names[k])
+                    .arg(units[k]);
+    }
     T_header += QString("# Projection: Local Rectangular\n");
     T_header += QString("# Information from grid:\n");
     T_header += QString("# Grid_size: %1 x %2 x %3\n").arg(nX).arg(nY).arg(nZ);
@@ -624,7 +952,7 @@ bool V2RhoT::saveFile(QString OutName) {
   }
 
   cout << "Writing temperature file " << OutName.toUtf8().data() << endl;
-  QFile tmp(OutName);
+  DataFile tmp(OutName);
 
   if (!tmp.open(QIODevice::WriteOnly | QIODevice::Text)) {
     cout << PRINT_ERROR "Could not open file " << OutName.toUtf8().data()
@@ -632,29 +960,217 @@ bool V2RhoT::saveFile(QString OutName) {
     exit(1);
   }
 
-  QTextStream fout(&tmp);
+  QTextStream fout(tmp.device());
   fout.setRealNumberPrecision(5);
   fout.setFieldAlignment(QTextStream::AlignRight);
   fout.setRealNumberNotation(QTextStream::FixedNotation);
   fout << T_header.toUtf8().data() << endl;
-  for (int i=0; i < data_T.length(); i++) {
-    fout << data_T[i].x();
+  const double *V = data.column(Dataset::V);
+  const double *T = temperatures(job);
+  const double *Rho = densities(job);
+  for (int i=0; i < data.size(); i++) {
+    fout << data.x(i);
     fout << "\t";
-    fout << data_T[i].y();
+    fout << data.y(i);
     fout << "\t";
-    fout << data_T[i].z();
+    fout << data.z(i);
     fout << "\t";
-    fout << data_V[i].v();
+    fout << V[i];
     fout << "\t";
     fout.setRealNumberPrecision(1);
-    fout << data_T[i].v();
+    fout << T[i];
     fout << "\t";
-    fout << data_T[i].prop();
+    fout << Rho[i];
+    for (int k=0; k < cols.size(); k++) {
+      fout.setRealNumberPrecision(units[k].endsWith("fraction") ? 4 : 1);
+      fout << "\t" << data.extra(cols[k])[i];
+    }
     fout.setRealNumberPrecision(5);
     fout << endl;
   }
 
-  tmp.close();
+  fout.flush();
+  return tmp.close();
+}
+
+bool V2RhoT::readNetCDF(QString InName) {
+  /**
+  Reads the velocity volume from a NetCDF file. Only the hyperslab given by
+  -slab is loaded, nodes with missing values are skipped.
+  **/
+  NetCDFGrid grid;
+  double x, y, z, val;
+
+  cout << "Reading file: " << InName.toUtf8().data() << endl;
+  grid.setSlab(NcSlab[0], NcSlab[1], NcSlab[2], NcSlab[3], NcSlab[4],
+               NcSlab[5]);
+  if (!grid.read(InName, NcVar)) {
+    cout << PRINT_ERROR "In " << InName.toUtf8().data() << ": "
+         << grid.error().toUtf8().data() << endl;
+    exit(1);
+  }
+
+  x_min1 = y_min1 = z_min1 = 1.7E308;
+  x_max1 = y_max1 = z_max1 = -x_min1;
+  data.setGrid(grid.nX(), grid.nY(), grid.nZ());
+  for (int n=0; n < grid.size(); n++) {
+    if (std::isnan(grid.value(n)))
+      continue;
+    x = grid.x(n);
+    y = grid.y(n);
+    z = scaleZ*grid.z(n);
+    val = scaleVs*grid.value(n);
+    if (val < 50) {
+      cout << endl << endl
+           << PRINT_WARNING "Imported velocity is < 50 m/s! Maybe imported "
+           << "velocities are in km/s?\n"
+           << "To convert to m/s use option -scaleV 1000\n"
+           << endl;
+      exit(1);
+    }
+    data.append(x, y, z, Dataset::V, val);
+
+    x_min1 = std::min(x_min1, x);
+    x_max1 = std::max(x_max1, x);
+    y_min1 = std::min(y_min1, y);
+    y_max1 = std::max(y_max1, y);
+    z_min1 = std::min(z_min1, z);
+    z_max1 = std::max(z_max1, z);
+  }
+  nX = grid.nX();
+  nY = grid.nY();
+  nZ = grid.nZ();
+  if (data.size() < grid.size()) {
+    cout << PRINT_WARNING << grid.size() - data.size() << " nodes without "
+            "value. Set output to scattered data.\n";
+    ArbitraryPoints = true;
+  }
+  return true;
+}
+
+bool V2RhoT::readJoint(QString InName) {
+  /**
+  Reads the velocities of the other wave type for -joint. The file holds the
+  points of File_In in the same order and format, the coordinates are
+  compared after scaling.
+  **/
+  bool match = true;
+  double x, y, z, val;
+  cout << "Reading file: " << InName.toUtf8().data() << endl;
+  V_joint.clear();
+  V_joint.reserve(data.size());
+
+  if (NetCDFGrid::isNetCDF(InName)) {
+    NetCDFGrid grid;
+    grid.setSlab(NcSlab[0], NcSlab[1], NcSlab[2], NcSlab[3], NcSlab[4],
+                 NcSlab[5]);
+    if (!grid.read(InName, NcVar)) {
+      cout << PRINT_ERROR "In " << InName.toUtf8().data() << ": "
+           << grid.error().toUtf8().data() << endl;
+      exit(1);
+    }
+    for (int n=0; n < grid.size(); n++) {
+      if (std::isnan(grid.value(n)))
+        continue;
+      int k = V_joint.size();
+      match = match && k < data.size()
+              && samePosition(data.x(k), grid.x(n))
+              && samePosition(data.y(k), grid.y(n))
+              && samePosition(data.z(k), scaleZ*grid.z(n));
+      V_joint.append(scaleVs*grid.value(n));
+    }
+  } else {
+    DataFile file(InName);
+    if (!file.open(QIODevice::ReadOnly)) {
+      cout << PRINT_ERROR "File " << InName.toUtf8().data() << " not found\n";
+      exit(1);
+    }
+    QTextStream stream(file.device());
+    int line = 0;
+    while (!stream.atEnd()) {
+      line++;
+      QString t = stream.readLine().simplified();
+      if (t.isEmpty() || t.startsWith("#"))
+        continue;
+      QStringList vals = t.split(" ");
+      bool okx = false, oky = false, okz = false, okval = false;
+      if (vals.count() == 4) {
+        x = vals[0].toDouble(&okx);
+        y = vals[1].toDouble(&oky);
+        z = scaleZ*vals[2].toDouble(&okz);
+        val = scaleVs*vals[3].toDouble(&okval);
+      }
+      if (!okx || !oky || !okz || !okval) {
+        cout << PRINT_ERROR "In line " << line << " of "
+             << InName.toUtf8().data() << endl;
+        exit(1);
+      }
+      int k = V_joint.size();
+      match = match && k < data.size() && samePosition(data.x(k), x)
+              && samePosition(data.y(k), y) && samePosition(data.z(k), z);
+      V_joint.append(val);
+    }
+    file.close();
+  }
+
+  if (!match || V_joint.size() != data.size()) {
+    cout << PRINT_ERROR << InName.toUtf8().data() << " does not hold the "
+         << "points of " << File_In.toUtf8().data() << " in the same order\n";
+    exit(1);
+  }
+  for (int k=0; k < V_joint.size(); k++) {
+    if (V_joint[k] < 50) {
+      cout << PRINT_WARNING "Imported velocity is < 50 m/s! Maybe imported "
+           << "velocities are in km/s?\n"
+           << "To convert to m/s use option -scaleV 1000\n";
+      exit(1);
+    }
+  }
+  return true;
+}
+
+bool V2RhoT::saveNetCDF(QString OutName, QString Info_header, int job) {
+  NetCDFGrid grid;
+  QVector<double> x, y, z;
+  QList<NetCDFVariable> vars;
+  NetCDFVariable V, T, Rho;
+
+  V.name = "V" + VelType;
+  V.long_name = VelType + "-wave velocity";
+  V.units = "m/s";
+  T.name = "T";
+  T.long_name = "Temperature";
+  T.units = "degC";
+  Rho.name = "Rho";
+  Rho.long_name = "Density";
+  Rho.units = "kg/m3";
+  for (int i=0; i < data.size(); i++) {
+    x.append(data.x(i));
+    y.append(data.y(i));
+    z.append(data.z(i));
+  }
+  V.vals = data.column(Dataset::V);
+  T.vals = temperatures(job);
+  Rho.vals = densities(job);
+  vars << V << T << Rho;
+  QList<int> cols;
+  QStringList units, long_names;
+  QStringList names = extraColumns(cols, units, long_names);
+  for (int k=0; k < cols.size(); k++) {
+    NetCDFVariable column;
+    column.name = names[k];
+    column.long_name = long_names[k];
+    column.units = units[k];
+    column.vals = data.extra(cols[k]);
+    vars.append(column);
+  }
+
+  cout << "Writing temperature file " << OutName.toUtf8().data() << endl;
+  if (!grid.write(OutName, x, y, z, vars, Info_header.remove("# "))) {
+    cout << PRINT_ERROR "Could not write " << OutName.toUtf8().data() << ": "
+         << grid.error().toUtf8().data() << endl;
+    exit(1);
+  }
   return true;
 }
 
@@ -708,14 +1224,13 @@ double V2RhoT::pressure_crust(double x, double y, double z) {
   double P_crust, t_mantle, P_mantle;
 
   // Get index in data_t_crust and data_z_topo
-  int i = 0;
-  while ((t_crust[i].x() != x) && (t_crust[i].y() != y))
-    i++;
-  i_crust = i;
-  i = 0;
-  while ((z_topo[i].x() != x) && (z_topo[i].y() != y))
-    i++;
-  i_topo = i;
+  i_crust = CrustIndex.find(x, y);
+  i_topo = TopoIndex.find(x, y);
+  if (i_crust < 0 || i_topo < 0) {
+    cout << PRINT_ERROR "No crustal thickness or topography at x = " << x
+         << ", y = " << y << endl;
+    exit(1);
+  }
 
   P_crust = rho_crust*c_g*t_crust[i_crust].z();              // Pressure crust
   t_mantle = z_topo[i_topo].z() - t_crust[i_crust].z() - z;  // Mantle thickness
@@ -731,11 +1246,27 @@ double V2RhoT::pressure_crust(double x, double y, double z) {
 }
 
 bool V2RhoT::Iterate() {
-  Point5D p5D;
-  int n_V, counter, progress;
-  double deltaT, T_n, T_n1;
-  double V, x, y, z, P, Vsyn, dVdTsyn;
-  QList <double> count_total;
+  /**
+  Converts every velocity into temperature and density with each rock
+  configuration in Jobs. Pressure is computed once per point and shared by
+  all jobs. The points are split into blocks, the pairs of job and block are
+  distributed over the threads, which invert with the const RockModel of the
+  job. Job 0 writes into the T and Rho columns of data, job k into the extra
+  columns 2k-2 and 2k-1.
+
+  With -checkpoint the results of completed units are appended to a side
+  file in intervals, -resume loads them and converts only the other units.
+  **/
+  const int block = 4096;  // Points per work unit of a thread
+  int n, K, n_blocks, n_units, n_done, progress;
+  n = data.size();
+  K = Jobs.size();
+  data.allocate();
+  data.allocateExtra(2*(K - 1) + 2*SensParams.size());
+  const double *V_obs = data.column(Dataset::V);
+  int *steps = data.iterations();
+  int *status = data.status();
+  const int *order = data.order(Order);
 
   cout << endl
        << "************************\n"
@@ -744,90 +1275,691 @@ bool V2RhoT::Iterate() {
        << "Threshold: " << threshold << " K\n"
        << "T_start: " << T_start << " K\n";
 
-  n_V = data_V.length();
-  for (int i=0; i < n_V; i++) {
-    V = data_V[i].v();
-    x = data_V[i].x();
-    y = data_V[i].y();
-    z = data_V[i].z();
-    P = pressure(x, y, z);
-    // Calculate all P/T independent rock properties
-    MantleRock->calc_prop(VelType);
-    T_n = T_start;    // Temperature at step n
-    T_n1 = 0.;        // Temperature at step n+1
-    counter = 0;
-    deltaT = threshold + 1;
-    while (deltaT > threshold) {
-      // Calculate rock properties
+  QVector<double> P(n);
+#ifdef _OPENMP
+  #pragma omp parallel for num_threads(threads())
+#endif
+  for (int i=0; i < n; i++)
+    P[i] = pressure(data.x(i), data.y(i), data.z(i));
+
+  if (MCRealizations > 0)
+    return monteCarlo(P.constData(), order);
+  if (!File_joint.isEmpty())
+    return jointInversion(P.constData(), order);
+
+  // In verbose mode the Rock builds its model when the first point is printed
+  QVector<const RockModel *> models(K, 0);
+  if (!verbose) {
+    for (int k=0; k < K; k++)
+      models[k] = &Jobs[k].MantleRock->model(VelType);
+  }
+
+  n_blocks = (n + block - 1)/block;
+  n_units = K*n_blocks;
+  n_done = 0;
+  progress = -1;
+  QVector<double> unit_steps(n_units, 0.);  // Sum of iteration steps
+  QVector<int> unit_fail(n_units, 0);       // Points without convergence
+  QVector<bool> unit_done(n_units, false);  // Loaded, not converted
+
+  Checkpoint checkpoint(checkpointFile());
+  bool checkpoints = CheckpointInterval > 0;
+  QList<int> pending;     // Completed units not yet in the checkpoint
+  QElapsedTimer checkpoint_timer;
+  if (checkpoints) {
+    // The input and the jobs file may have been edited before -resume
+    quint64 h = Checkpoint::hash(reinterpret_cast<const char *>(V_obs),
+                                 static_cast<qint64>(n)*sizeof(double));
+    h = Checkpoint::hash(reinterpret_cast<const char *>(P.constData()),
+                         static_cast<qint64>(n)*sizeof(double), h);
+    h = Checkpoint::hash(reinterpret_cast<const char *>(order),
+                         static_cast<qint64>(n)*sizeof(int), h);
+    if (!File_jobs.isEmpty()) {
+      QFile jobs(File_jobs);
+      if (jobs.open(QIODevice::ReadOnly)) {
+        QByteArray contents = jobs.readAll();
+        h = Checkpoint::hash(contents.constData(), contents.size(), h);
+      }
+    }
+    QByteArray signature = QString("%1 points, %2 jobs, %3 per unit, input "
+                                   "%4: %5")
+                           .arg(n).arg(K).arg(block).arg(h)
+                           .arg(Settings).toUtf8();
+    QList<int> units;
+    QList<QByteArray> records;
+    bool ok;
+    if (Resume && QFile::exists(checkpointFile())) {
+      ok = checkpoint.resume(signature, units, records);
+    } else {
+      if (Resume)
+        cout << PRINT_WARNING "No checkpoint "
+             << checkpointFile().toUtf8().data()
+             << ", starting from the first point\n";
+      ok = checkpoint.start(signature);
+    }
+    if (!ok) {
+      cout << PRINT_ERROR << checkpoint.error().toUtf8().data() << endl;
+      exit(1);
+    }
+    for (int r=0; r < units.size(); r++) {
+      int u = units[r];
+      int b = u % n_blocks;
+      int k_end = qMin(n, (b + 1)*block);
+      if (u < 0 || u >= n_units || unit_done[u]
+          || !unpackUnit(u/n_blocks, order, b*block, k_end,
+                         records[r].constData(), records[r].size(),
+                         unit_steps[u], unit_fail[u])) {
+        cout << PRINT_ERROR "Invalid record in "
+             << checkpointFile().toUtf8().data() << endl;
+        exit(1);
+      }
+      unit_done[u] = true;
+      n_done += k_end - b*block;
+    }
+    if (Resume) {
+      cout << "Resuming with " << units.size() << " of " << n_units
+           << " work units done\n";
+    }
+    checkpoint_timer.start();
+  }
+
+  // Units whose velocities, pressures and settings did not change since the
+  // last run are taken from its chunk file
+  QVector<quint64> unit_key;
+  const QByteArray chunk_signature("VeloDT V2RhoT chunks");
+  if (Incremental) {
+    QVector<QByteArray> settings(K);
+    for (int k=0; k < K; k++)
+      settings[k] = jobSettings(k);
+    unit_key.resize(n_units);
+    for (int u=0; u < n_units; u++) {
+      int b = u % n_blocks;
+      unit_key[u] = chunkKey(settings[u/n_blocks], order, b*block,
+                             qMin(n, (b + 1)*block), P.constData());
+    }
+
+    Checkpoint chunks(chunkFile());
+    QList<int> units;
+    QList<QByteArray> records;
+    QMap<quint64, int> found;
+    if (QFile::exists(chunkFile())) {
+      if (!chunks.read(chunk_signature, units, records)) {
+        cout << PRINT_WARNING << chunks.error().toUtf8().data()
+             << ", converting all points\n";
+      }
+      for (int r=0; r < records.size(); r++) {
+        quint64 key;
+        if (records[r].size() < static_cast<int>(sizeof(key)))
+          continue;
+        memcpy(&key, records[r].constData(), sizeof(key));
+        found.insert(key, r);
+      }
+    }
+    int reused = 0;
+    for (int u=0; u < n_units; u++) {
+      int b = u % n_blocks;
+      int k_end = qMin(n, (b + 1)*block);
+      if (unit_done[u] || !found.contains(unit_key[u]))
+        continue;
+      const QByteArray &rec = records[found.value(unit_key[u])];
+      if (unpackUnit(u/n_blocks, order, b*block, k_end,
+                     rec.constData() + sizeof(quint64),
+                     rec.size() - sizeof(quint64), unit_steps[u],
+                     unit_fail[u])) {
+        unit_done[u] = true;
+        n_done += k_end - b*block;
+        reused++;
+      }
+    }
+    cout << "Incremental: " << reused << " of " << n_units
+         << " work units unchanged\n";
+  }
+
+#ifdef _OPENMP
+  #pragma omp parallel for schedule(dynamic) num_threads(threads())
+#endif
+  for (int u=0; u < n_units; u++) {
+    if (unit_done[u])
+      continue;
+    int job = u/n_blocks;
+    int b = u % n_blocks;
+    int k_end = qMin(n, (b + 1)*block);
+    double *T_out = temperatures(job);
+    double *Rho_out = densities(job);
+    double sum = 0;
+    int n_fail = 0;
+
+    for (int k=b*block; k < k_end; k++) {
+      int i = order[k];
+      double V = V_obs[i];
+      double T_n1, rho;
+      int counter;
+      bool ok;
       if (verbose) {
         cout << endl << endl
-             << "Point " << i+1 << ", Step " << counter << endl
-             << "X                " << x << endl
-             << "Y                " << y << endl
-             << "Z                " << z << endl
-             << "Step T           " << T_n << endl
-             << "Delta T          " << deltaT << endl
+             << "Point " << i+1 << endl
+             << "X                " << data.x(i) << endl
+             << "Y                " << data.y(i) << endl
+             << "Z                " << data.z(i) << endl
              << "Measured V       " << V << endl;
+        Rock *rock = Jobs[job].MantleRock;
+        ok = rock->invert(V, P[i], T_start, c_Fdamp, threshold, VelType, T_n1,
+                          counter);
+        rho = rock->getRho();
+      } else {
+        RockProperties props;
+        ok = models[job]->invert(V, P[i], T_start, c_Fdamp, threshold, T_n1,
+                                 counter, props);
+        rho = props.rho;
+        if (!props.inTable) {
+#ifdef _OPENMP
+          #pragma omp critical(output)
+#endif
+          cout << PRINT_WARNING "Iteration failed. Temperature out of bounds T="
+               << props.T << " K\n";
+        }
       }
-      MantleRock->calc_prop_PT(P, T_n, VelType);
-      Vsyn = MantleRock->get_Vsyn_PT();
-      dVdTsyn = MantleRock->get_dVdTsyn_PT();
-      T_n1 = T_n + c_Fdamp*(V - Vsyn)/dVdTsyn;
-      deltaT = abs(T_n - T_n1);
-      counter = counter + 1;
-      if (counter > 10000) {
+      if (!ok) {
+        n_fail++;
+#ifdef _OPENMP
+        #pragma omp critical(output)
+#endif
         cout << "Too many iterations at point " << i << endl
-             << "X(" << x << ") Y(" << y <<") Z(" << z << ") V(" << V << ")\n"
+             << "X(" << data.x(i) << ") Y(" << data.y(i) << ") Z("
+             << data.z(i) << ") V(" << V << ")\n"
              << "Set T=-1\n";
-        T_n1 = 272.15;
-        break;
+        if (job == 0)
+          status[i] = Dataset::NotConverged;
       }
-      T_n = T_n1;
-    }
 
-    if (verbose) {
-      cout << "Iteration finished, deltaT = " << deltaT
-           << ", T = " << T_n1 << endl;
+      T_out[i] = T_n1-273.15;
+      Rho_out[i] = rho;
+      if (job == 0)
+        steps[i] = counter;
+      sum += counter;
     }
 
-    p5D.setV(T_n1-273.15);
-    p5D.setX(x);
-    p5D.setY(y);
-    p5D.setZ(z);
-    p5D.setProp(MantleRock->getRho());
-    data_T.append(p5D);
-    count_total.append(static_cast<double>(counter));
+    // Progress is reported per block, by whichever thread finishes one
+#ifdef _OPENMP
+    #pragma omp critical(output)
+#endif
+    {
+      unit_steps[u] = sum;
+      unit_fail[u] = n_fail;
+      n_done += k_end - b*block;
+      int percent = static_cast<int>(100.0*n_done/(static_cast<double>(n)*K));
+      if (!verbose && percent/5 != progress/5) {
+        progress = percent;
+        printf("\rProgress: %i       ", progress);
+        fflush(stdout);
+      }
+
+      // Append the units finished since the last checkpoint, the last unit
+      // always writes so that a run killed while saving can be resumed
+      if (checkpoints) {
+        pending.append(u);
+        if (checkpoint_timer.elapsed() >= 1000*CheckpointInterval
+            || n_done == n*K) {
+          for (int p=0; p < pending.size(); p++) {
+            int v = pending[p];
+            int b_v = v % n_blocks;
+            checkpoint.append(v, packUnit(v/n_blocks, order, b_v*block,
+                                          qMin(n, (b_v + 1)*block),
+                                          unit_steps[v], unit_fail[v]));
+          }
+          pending.clear();
+          if (!checkpoint.flush()) {
+            cout << endl << PRINT_WARNING
+                 << checkpoint.error().toUtf8().data()
+                 << ", no further checkpoints" << endl;
+            checkpoints = false;
+          }
+          checkpoint_timer.restart();
+        }
+      }
+    }
+  }
+  cout << endl;
 
-    progress = static_cast<int>(
-               round(static_cast<double>(i)/static_cast<double>(n_V))*100.0);
-    if (progress % 5 == 0) {
-      printf("\rProgress: %i  ", progress);
+  // Key and results of every unit for the next incremental run
+  if (Incremental) {
+    Checkpoint chunks(chunkFile());
+    bool ok = chunks.start(chunk_signature);
+    for (int u=0; ok && u < n_units; u++) {
+      int b = u % n_blocks;
+      QByteArray rec(reinterpret_cast<const char *>(&unit_key[u]),
+                     sizeof(quint64));
+      rec += packUnit(u/n_blocks, order, b*block, qMin(n, (b + 1)*block),
+                      unit_steps[u], unit_fail[u]);
+      chunks.append(u, rec);
     }
+    if (!ok || !chunks.flush())
+      cout << PRINT_WARNING << chunks.error().toUtf8().data() << endl;
   }
-  printf("\rProgress: 100\n");
+
+  if (!SensParams.isEmpty())
+    sensitivities(P.constData());
 
   // Calculate average counts
-  count_avrg = 0;
-  for (int i=0; i < n_V; i++) {
-    count_avrg = count_avrg + count_total[i];
+  for (int u=0; u < n_units; u++) {
+    Jobs[u/n_blocks].count_avrg += unit_steps[u];
+    Jobs[u/n_blocks].n_fail += unit_fail[u];
+  }
+  for (int k=0; k < K; k++) {
+    Jobs[k].count_avrg /= n;
+    if (K > 1)
+      cout << Jobs[k].FileOut.toUtf8().data() << ": ";
+    cout << "Average iteration steps: " << Jobs[k].count_avrg << endl;
+    if (Jobs[k].n_fail > 0)
+      cout << PRINT_WARNING << Jobs[k].n_fail << " points did not converge\n";
+  }
+  return true;
+}
+
+bool V2RhoT::monteCarlo(const double *P, const int *order) {
+  /**
+  Propagates the uncertainty of the mineral properties and anelasticity
+  parameters through the conversion. Every point is converted with
+  MCRealizations perturbed rocks drawn by RockEnsemble. Temperatures and
+  densities are reduced to mean, standard deviation and quantiles as they are
+  computed (StreamingStats), so memory does not depend on the number of
+  realizations. T and Rho of data receive the means, the extra columns the
+  other statistics, see statColumns(). Inversions that do not converge are
+  left out.
+
+  Realizations are built in batches. The threads take blocks of points and
+  convert them with every realization of the batch, so each point receives
+  its samples in the order of the realizations and the results do not depend
+  on the number of threads.
+  **/
+  const int block = 4096;  // Points per work unit of a thread
+  const int batch = 64;    // Realizations built at a time
+  int n = data.size();
+  int n_blocks = (n + block - 1)/block;
+  int nQ = MCQuantiles.size();
+  int progress = -1;
+  double steps_sum = 0;
+  qint64 n_fail = 0;
+  const double *V_obs = data.column(Dataset::V);
+  RockEnsemble ensemble(MantleRock->mineralSet(), MantleRock->anelasticity(),
+                        MCSigma, MCSeed);
+  StreamingStats T_stats(n, MCQuantiles);
+  StreamingStats Rho_stats(n, MCQuantiles);
+
+  for (int r0=0; r0 < MCRealizations; r0 += batch) {
+    int m = qMin(batch, MCRealizations - r0);
+    QVector<MineralSet> sets(m);    // Referenced by the models
+    QVector<RockModel *> models(m);
+    for (int r=0; r < m; r++) {
+      QModel q;
+      ensemble.realization(r0 + r, sets[r], q);
+      models[r] = MantleRock->model(sets[r], q, VelType);
+    }
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(threads()) \
+            reduction(+:steps_sum, n_fail)
+#endif
+    for (int b=0; b < n_blocks; b++) {
+      int k_end = qMin(n, (b + 1)*block);
+      for (int k=b*block; k < k_end; k++) {
+        int i = order[k];
+        for (int r=0; r < m; r++) {
+          double T;
+          int counter;
+          RockProperties props;
+          bool ok = models[r]->invert(V_obs[i], P[i], T_start, c_Fdamp,
+                                      threshold, T, counter, props);
+          steps_sum += counter;
+          if (!ok) {
+            n_fail++;
+            continue;
+          }
+          T_stats.add(i, T - 273.15);
+          Rho_stats.add(i, props.rho);
+        }
+      }
+    }
+
+    for (int r=0; r < m; r++)
+      delete models[r];
+    int percent = static_cast<int>(100.0*(r0 + m)/MCRealizations);
+    if (percent/5 != progress/5) {
+      progress = percent;
+      printf("\rProgress: %i       ", progress);
+      fflush(stdout);
+    }
+  }
+  cout << endl;
+
+  // Statistics into the columns of data, -1 without a converged realization
+  data.allocateExtra(2 + 2*nQ);
+  double *T_out = data.column(Dataset::T);
+  double *Rho_out = data.column(Dataset::Rho);
+  int *status = data.status();
+  for (int i=0; i < n; i++) {
+    bool ok = T_stats.count(i) > 0;
+    T_out[i] = ok ? T_stats.mean(i) : -1;
+    Rho_out[i] = ok ? Rho_stats.mean(i) : -1;
+    data.extra(0)[i] = ok ? T_stats.std(i) : -1;
+    data.extra(1)[i] = ok ? Rho_stats.std(i) : -1;
+    for (int q=0; q < nQ; q++) {
+      data.extra(2 + q)[i] = ok ? T_stats.quantile(i, q) : -1;
+      data.extra(2 + nQ + q)[i] = ok ? Rho_stats.quantile(i, q) : -1;
+    }
+    if (!ok)
+      status[i] = Dataset::NotConverged;
+  }
+
+  Jobs[0].count_avrg = steps_sum/n/MCRealizations;
+  cout << "Average iteration steps: " << Jobs[0].count_avrg << endl;
+  if (n_fail > 0) {
+    cout << PRINT_WARNING << n_fail << " of "
+         << static_cast<qint64>(n)*MCRealizations
+         << " inversions did not converge\n";
   }
-  count_avrg = count_avrg/n_V;
-  cout << "Average iteration steps: " << count_avrg << endl;
   return true;
 }
 
+QStringList V2RhoT::extraColumns(QList<int> &cols, QStringList &units,
+                                 QStringList &long_names) {
+  /**
+  Names of the columns written after T and Rho, i.e. the statistics of a
+  Monte Carlo run or the sensitivities. cols returns their indices in
+  data.extra(), units and long_names their units and descriptions.
+  **/
+  QStringList names;
+  cols.clear();
+  units.clear();
+  long_names.clear();
+  if (MCRealizations > 0) {
+    names << "T_std" << "Rho_std";
+    long_names << "Standard deviation of temperature"
+               << "Standard deviation of density";
+    units << "degC" << "kg/m3";
+    for (int q=0; q < MCQuantiles.size(); q++) {
+      names << QString("T_q%1").arg(100*MCQuantiles[q]);
+      long_names << QString("Quantile %1 % of temperature")
+                    .arg(100*MCQuantiles[q]);
+      units << "degC";
+    }
+    for (int q=0; q < MCQuantiles.size(); q++) {
+      names << QString("Rho_q%1").arg(100*MCQuantiles[q]);
+      long_names << QString("Quantile %1 % of density")
+                    .arg(100*MCQuantiles[q]);
+      units << "kg/m3";
+    }
+  }
+  if (!File_joint.isEmpty()) {
+    bool xfe = JointParam.kind == RockParameter::XFe;
+    names << JointName << "misfit";
+    long_names << (xfe ? "Iron content XFe" : "Fraction of " + JointName)
+               << "RMS misfit of P- and S-wave velocity";
+    units << (xfe ? "mole fraction" : "fraction") << "m/s";
+  }
+  for (int p=0; p < SensNames.size(); p++) {
+    names << "dT_" + SensNames[p] << "dRho_" + SensNames[p];
+    long_names << "Sensitivity of temperature to " + SensNames[p]
+               << "Sensitivity of density to " + SensNames[p];
+    units << "K" << "kg/m3";
+  }
+  for (int k=0; k < names.size(); k++)
+    cols << k;
+  return names;
+}
+
+void V2RhoT::sensitivities(const double *P) {
+  /**
+  Derivatives of temperature and density of every converged point with
+  respect to the parameters of -sens, by forward-mode automatic
+  differentiation of the rock model at the converted temperature, see
+  RockModel::sensitivities(). Column 2p of data.extra() receives dT/dparam p,
+  column 2p+1 drho/dparam p. Points that did not converge keep NaN.
+  **/
+  int n = data.size();
+  int n_par = SensParams.size();
+  const RockModel &model = MantleRock->model(VelType);
+  QVector<RockCoefficients<Dual> > params(n_par);
+  for (int p=0; p < n_par; p++)
+    params[p] = model.coefficients<Dual>(SensParams[p]);
+  const double *T = data.column(Dataset::T);
+  const int *status = data.status();
+
+  cout << "Computing sensitivities to " << n_par << " parameters\n";
+#ifdef _OPENMP
+  #pragma omp parallel num_threads(threads())
+#endif
+  {
+    QVector<double> dT(n_par), dRho(n_par);
+#ifdef _OPENMP
+    #pragma omp for
+#endif
+    for (int i=0; i < n; i++) {
+      if (status[i] == Dataset::NotConverged)
+        continue;
+      model.sensitivities(P[i], T[i] + 273.15, params.constData(), n_par,
+                          dT.data(), dRho.data());
+      for (int p=0; p < n_par; p++) {
+        data.extra(2*p)[i] = dT[p];
+        data.extra(2*p + 1)[i] = dRho[p];
+      }
+    }
+  }
+}
+
+bool V2RhoT::jointInversion(const double *P, const int *order) {
+  /**
+  Converts the velocities of both wave types at every point into temperature
+  and the unknown of -joint, see JointInversion. Each thread converts blocks
+  of points in the order given by -order, every point starting from the
+  result of the previous one in its block. A point that does not converge
+  from there is converted again from T_start and the base rock, so results
+  do not depend on the number of threads. Points that keep a misfit above
+  misfit_tolerance, i.e. need an unknown outside [0, 1], count as not
+  converged. The unknown goes into extra column 0, the remaining RMS misfit
+  into column 1.
+  **/
+  const int block = 4096;  // Points per work unit of a thread
+  const double c_threshold = 1e-4;  // Convergence of the unknown
+  const double misfit_tolerance = 1;  // m/s
+  int n = data.size();
+  int n_blocks = (n + block - 1)/block;
+  int n_done = 0, progress = -1;
+  double steps_sum = 0;
+  int n_fail = 0;
+  data.allocateExtra(2);
+  const double *V_obs = data.column(Dataset::V);
+  double *T_out = data.column(Dataset::T);
+  double *Rho_out = data.column(Dataset::Rho);
+  double *c_out = data.extra(0);
+  double *misfit = data.extra(1);
+  int *steps = data.iterations();
+  int *status = data.status();
+
+  // Vp first, the other wave type at its default frequency unless -f is set
+  QString other = (VelType == "P") ? "S" : "P";
+  const RockModel &primary = MantleRock->model(VelType);
+  RockModel *secondary = MantleRock->model(other, CustomFreq >= 0 ? CustomFreq
+                                           : Rock::defaultFrequency(other));
+  bool p_first = (VelType == "P");
+  JointInversion joint(p_first ? primary : *secondary,
+                       p_first ? *secondary : primary, JointParam);
+  double c0 = joint.initial();
+
+#ifdef _OPENMP
+  #pragma omp parallel for schedule(dynamic) num_threads(threads()) \
+          reduction(+:steps_sum, n_fail)
+#endif
+  for (int b=0; b < n_blocks; b++) {
+    int k_end = qMin(n, (b + 1)*block);
+    double T_warm = T_start, c_warm = c0;
+    for (int k=b*block; k < k_end; k++) {
+      int i = order[k];
+      double Vp = p_first ? V_obs[i] : V_joint[i];
+      double Vs = p_first ? V_joint[i] : V_obs[i];
+      JointResult r, cold;
+      bool conv = joint.invert(Vp, Vs, P[i], T_warm, c_warm, threshold,
+                               c_threshold, r);
+      int counter = r.steps;
+      if ((!conv || r.misfit > misfit_tolerance)
+          && (T_warm != T_start || c_warm != c0)) {
+        bool conv_cold = joint.invert(Vp, Vs, P[i], T_start, c0, threshold,
+                                      c_threshold, cold);
+        counter += cold.steps;
+        if (conv_cold && (!conv || cold.misfit < r.misfit)) {
+          r = cold;
+          conv = true;
+        }
+      }
+      bool ok = conv && r.misfit <= misfit_tolerance;
+      if (ok) {
+        T_warm = r.T;
+        c_warm = r.c;
+      } else {
+        n_fail++;
+        status[i] = Dataset::NotConverged;
+        T_warm = T_start;
+        c_warm = c0;
+      }
+      T_out[i] = r.T - 273.15;
+      Rho_out[i] = r.rho;
+      c_out[i] = r.c;
+      misfit[i] = r.misfit;
+      steps[i] = counter;
+      steps_sum += counter;
+    }
+
+#ifdef _OPENMP
+    #pragma omp critical(output)
+#endif
+    {
+      n_done += k_end - b*block;
+      int percent = static_cast<int>(100.0*n_done/n);
+      if (percent/5 != progress/5) {
+        progress = percent;
+        printf("\rProgress: %i       ", progress);
+        fflush(stdout);
+      }
+    }
+  }
+  cout << endl;
+  delete secondary;
+
+  Jobs[0].count_avrg = steps_sum/n;
+  Jobs[0].n_fail = n_fail;
+  cout << "Average iteration steps: " << Jobs[0].count_avrg << endl;
+  if (n_fail > 0)
+    cout << PRINT_WARNING << n_fail << " points did not converge\n";
+  return true;
+}
+
+QByteArray V2RhoT::packUnit(int job, const int *order, int k0, int k1,
+                            double sum, int n_fail) {
+  /**
+  Checkpoint record of the points order[k0] to order[k1-1] of a job: sum of
+  iteration steps, failures, temperatures and densities, and for job 0 the
+  iteration steps and status of every point.
+  **/
+  const double *T = temperatures(job);
+  const double *Rho = densities(job);
+  int m = k1 - k0;
+  QVector<double> vals(1 + 2*m);
+  QVector<qint32> ints(1 + ((job == 0) ? 2*m : 0));
+  vals[0] = sum;
+  ints[0] = n_fail;
+  for (int k=k0; k < k1; k++) {
+    int i = order[k];
+    vals[1 + k - k0] = T[i];
+    vals[1 + m + k - k0] = Rho[i];
+    if (job == 0) {
+      ints[1 + k - k0] = data.iterations()[i];
+      ints[1 + m + k - k0] = data.status()[i];
+    }
+  }
+  QByteArray rec(reinterpret_cast<const char *>(vals.constData()),
+                 vals.size()*sizeof(double));
+  rec.append(reinterpret_cast<const char *>(ints.constData()),
+             ints.size()*sizeof(qint32));
+  return rec;
+}
+
+bool V2RhoT::unpackUnit(int job, const int *order, int k0, int k1,
+                        const char *rec, int size, double &sum, int &n_fail) {
+  // Inverse of packUnit(), false if the record does not fit the unit
+  int m = k1 - k0;
+  QVector<double> vals(1 + 2*m);
+  QVector<qint32> ints(1 + ((job == 0) ? 2*m : 0));
+  int n_vals = vals.size()*sizeof(double);
+  int n_ints = ints.size()*sizeof(qint32);
+  if (size != n_vals + n_ints)
+    return false;
+  memcpy(vals.data(), rec, n_vals);
+  memcpy(ints.data(), rec + n_vals, n_ints);
+
+  double *T = temperatures(job);
+  double *Rho = densities(job);
+  sum = vals[0];
+  n_fail = ints[0];
+  for (int k=k0; k < k1; k++) {
+    int i = order[k];
+    T[i] = vals[1 + k - k0];
+    Rho[i] = vals[1 + m + k - k0];
+    if (job == 0) {
+      data.iterations()[i] = ints[1 + k - k0];
+      data.status()[i] = ints[1 + m + k - k0];
+    }
+  }
+  return true;
+}
+
+QByteArray V2RhoT::jobSettings(int job) {
+  // Everything besides velocity and pressure that changes the results of a job
+  Rock *rock = Jobs[job].MantleRock;
+  QString s = QString("%1 %2 %3 %4 %5 %6 %7 %8 %9")
+              .arg(VelType).arg(threshold, 0, 'g', 17).arg(T_start, 0, 'g', 17)
+              .arg(c_Fdamp, 0, 'g', 17).arg(rock->get_MineralPropertyDB())
+              .arg(rock->get_AlphaMode()).arg(rock->getQ())
+              .arg(rock->get_frequency(), 0, 'g', 17)
+              .arg(rock->getXFe(), 0, 'g', 17);
+  for (int c=0; c < 5; c++)
+    s += QString(" %1").arg(rock->getComposition(c), 0, 'g', 17);
+  return s.toUtf8();
+}
+
+quint64 V2RhoT::chunkKey(const QByteArray &settings, const int *order, int k0,
+                         int k1, const double *P) {
+  /**
+  Content hash of the work unit order[k0] to order[k1-1] of a job. The result
+  of a point only depends on its velocity and pressure besides the settings,
+  so changes of coordinates, pressure method or crustal model are covered by
+  the pressures.
+  **/
+  const double *V = data.column(Dataset::V);
+  quint64 h = Checkpoint::hash(settings.constData(), settings.size());
+  for (int k=k0; k < k1; k++) {
+    double vp[2] = {V[order[k]], P[order[k]]};
+    h = Checkpoint::hash(reinterpret_cast<const char *>(vp), sizeof(vp), h);
+  }
+  return h;
+}
+
+void V2RhoT::removeCheckpoint() {
+  // Called after all output files were written
+  if (CheckpointInterval > 0)
+    QFile::remove(checkpointFile());
+}
+
+int V2RhoT::threads() {
+  // Number of threads used by Iterate()
+#ifdef _OPENMP
+  if (verbose)
+    return 1;
+  return (Threads > 0) ? Threads : omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
 //##############################################################################
 // Code
 //##############################################################################
-int main(int argc, char *argv[]) {
-  V2RhoT VelTemp;
-  if (argc > 0) {
-    VelTemp.readArgs(argc, argv);
-    VelTemp.Info();
-    VelTemp.readFile(VelTemp.FileIn(), "vox");
-    VelTemp.Iterate();
-    VelTemp.saveFile(VelTemp.FileOut());
-  } else {
-    VelTemp.usage();
-  }
-}
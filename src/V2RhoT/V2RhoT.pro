@@ -19,14 +19,27 @@ TEMPLATE = app
 DESTDIR = ../../bin
 TARGET = V2RhoT
 CONFIG -= app_bundle
+CONFIG += c++11
 
 INCLUDEPATH += ../../include/common ../../include/V2RhoT
 
 LIBS += -L../common -lcommon
+netcdf {
+  LIBS += -lnetcdf
+}
+# OpenMP parallelises the conversion, disable with 'qmake CONFIG+=no_openmp'
+!no_openmp {
+  QMAKE_CXXFLAGS += -fopenmp
+  QMAKE_LFLAGS += -fopenmp
+}
 
-SOURCES += V2RhoT.cpp Rock.cpp MineraldRhodT.cpp
+SOURCES += main.cpp V2RhoT.cpp Rock.cpp RockModel.cpp MineraldRhodT.cpp \
+           RockEnsemble.cpp JointInversion.cpp
 
 HEADERS += ../../include/V2RhoT/V2RhoT.h \
            ../../include/V2RhoT/Rock.h \
-           ../../include/V2RhoT/MineraldRhodT.h
+           ../../include/V2RhoT/RockModel.h \
+           ../../include/V2RhoT/MineraldRhodT.h \
+           ../../include/V2RhoT/RockEnsemble.h \
+           ../../include/V2RhoT/JointInversion.h
 
@@ -0,0 +1,45 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#include "V2RhoT.h"
+
+using std::cout;
+using std::endl;
+
+int main(int argc, char *argv[]) {
+  V2RhoT VelTemp;
+  QElapsedTimer timer;
+  qint64 t_read, t_conv;
+  if (argc > 0) {
+    VelTemp.readArgs(argc, argv);
+    VelTemp.Info();
+    timer.start();
+    VelTemp.readFile(VelTemp.FileIn(), "vox");
+    if (!VelTemp.FileJoint().isEmpty())
+      VelTemp.readJoint(VelTemp.FileJoint());
+    t_read = timer.restart();
+    VelTemp.Iterate();
+    t_conv = timer.restart();
+    for (int k=0; k < VelTemp.jobs(); k++)
+      VelTemp.saveFile(VelTemp.FileOut(k), k);
+    VelTemp.removeCheckpoint();
+    cout << "Run time / s: reading " << t_read/1000.0 << ", conversion "
+         << t_conv/1000.0 << ", writing " << timer.elapsed()/1000.0 << endl;
+  } else {
+    VelTemp.usage();
+  }
+}
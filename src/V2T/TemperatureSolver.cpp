@@ -0,0 +1,242 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#include "TemperatureSolver.h"
+
+TemperatureSolver::TemperatureSolver() {
+  threshold = 0.1;
+  c_K = 273.15;
+  Guess = LambertW;
+  Solver = Halley;
+  T_min = 1E-6 - c_K;
+  T_max = 3000;
+}
+
+Calibration TemperatureSolver::defaults() {
+  // Constants given by Priestley and McKenzie (2006)
+  Calibration p;
+  p.bV = 3.84E-4;  // 1/km
+  p.m  = -2.8E-4;  // km/s
+  p.c  = 4.72;     // km/s
+  p.A  = -1.8E13;  // km/s
+  p.E  = 409.0;    // kJ/mol
+  p.Va = 10E-6;    // m3/mol
+  return p;
+}
+
+double TemperatureSolver::initialGuess(const Calibration &p, double VsS,
+                                       double H) const {
+  /**
+  Starting temperature / degC for the Newton iteration. With u = T + c_K the
+  exponent -H/u is replaced by its tangent -2H/u0 + lambda*u at u0, with
+  lambda = H/u0^2. Then f(T) = 0 becomes c_m*u + b + D*exp(lambda*u) = 0 with
+  b = c_c - VsS - c_m*c_K and D = c_A*exp(-2H/u0), which is solved by
+
+  u = -b/c_m - W(z)/lambda,  z = lambda*D/c_m*exp(-lambda*b/c_m)
+
+  where W is the principal branch of the Lambert W function. The equation is
+  solved three times, first with the tangent at 1000 degC and then twice with
+  the tangent at the last u. The error then is well below 1 degC and one or
+  two Newton steps are left.
+  **/
+  const int solves = 3;
+  double u = 1000.0 + c_K;
+  double b = p.c - VsS - p.m*c_K;
+  for (int pivot=0; pivot < solves; pivot++) {
+    double lambda = H/(u*u);
+    double a = lambda*p.A/p.m;
+    if (a <= 0)
+      return 1000.0;
+    // ln(z), z overflows for typical parameters
+    double lnz = log(a) - 2*H/u - lambda*b/p.m;
+    u = -b/p.m - lambertW(lnz)/lambda;
+  }
+  if (!(u > 0))
+    return 1000.0;
+  return u - c_K;
+}
+
+double TemperatureSolver::lambertW(double lnz) {
+  /**
+  Principal branch of the Lambert W function for z = exp(lnz) > 0. Newton
+  iteration on w + ln(w) = ln(z), which converges quadratically from the
+  asymptotic expansions of W.
+  **/
+  double w = (lnz > 1) ? lnz - log(lnz) : log1p(exp(lnz));
+  for (int i=0; i < 3; i++)
+    w = w*(1 + lnz - log(w))/(1 + w);
+  return w;
+}
+
+void TemperatureSolver::temperatures(int n, const Calibration *p,
+                                     const double *VsS, const double *H,
+                                     double *T, int *steps, int *stat) const {
+  /**
+  Solves f(T) = 0 for n <= Lanes points at once. T returns the temperatures
+  in degC, -1 if no temperature was found, steps the number of iterations and
+  stat the Dataset::Status of each point. All points take a step together
+  and points that converged or failed are masked out, so the loop over the
+  lanes can be vectorised. Only reads members, so it is called by several
+  threads at once.
+  p     Parameter set of each point
+  VsS   Corrected velocities / km/s
+  H     Activation terms, see activation() / K
+
+  Solver Newton is the plain Newton iteration, which fails on a zero
+  derivative or after 10000 steps. Solver Halley keeps the root bracketed
+  between T_min and T_max and takes Halley steps (cubic convergence) as long
+  as they stay inside the bracket, otherwise it bisects. After 32 steps only
+  bisection is used, so every point converges in at most 32 + log2((T_max -
+  T_min)/threshold) steps. Only points without a root between the bounds
+  have no temperature.
+  **/
+  double f, df, theta;
+  bool active[Lanes];
+  int n_active = 0;
+
+  for (int l=0; l < n; l++) {
+    steps[l] = 0;
+    stat[l] = Dataset::Ok;
+    // See Priestley and McKenzie (2006), Eqn 10
+    active[l] = (VsS[l] < 4.4);
+    if (active[l]) {
+      if (Guess == LambertW) {
+        T[l] = initialGuess(p[l], VsS[l], H[l]);
+      } else {
+        // Calculate initial T estimate from theta_init = 1000 degC
+        fdf(p[l], VsS[l], H[l], 1000.0, f, df);
+        T[l] = 1000.0 - f/df;
+      }
+      n_active++;
+    } else {
+      T[l] = (VsS[l]-p[l].c)/p[l].m;
+    }
+  }
+
+  if (Solver == Halley) {
+    halley(n, p, VsS, H, T, steps, stat, active);
+    return;
+  }
+
+  while (n_active > 0) {
+    n_active = 0;
+#ifdef _OPENMP
+    #pragma omp simd private(f, df, theta) reduction(+:n_active)
+#endif
+    for (int l=0; l < n; l++) {
+      if (!active[l])
+        continue;
+      fdf(p[l], VsS[l], H[l], T[l], f, df);
+      if (df == 0) {
+        stat[l] = Dataset::ZeroDivision;
+        T[l] = -1;
+        active[l] = false;
+        continue;
+      }
+      theta = T[l] - f/df;
+      active[l] = (fabs(theta - T[l]) > threshold);
+      T[l] = theta;
+      steps[l]++;
+      if (steps[l] > 10000) {
+        stat[l] = Dataset::NotConverged;
+        T[l] = -1;
+        active[l] = false;
+      }
+      n_active += active[l];
+    }
+  }
+}
+
+void TemperatureSolver::halley(int n, const Calibration *p,
+                               const double *VsS, const double *H, double *T,
+                               int *steps, int *stat, bool *active) const {
+  /**
+  Bracketed Halley iteration of temperatures(), starting from T for the
+  active points.
+  **/
+  const int max_halley = 32;  // Steps before falling back to bisection
+  double f, df, d2f, theta, lo[Lanes], hi[Lanes];
+  bool up[Lanes];             // f(lo) > 0
+  int n_active = 0;
+
+  for (int l=0; l < n; l++) {
+    if (!active[l])
+      continue;
+    double f_lo, f_hi;
+    lo[l] = T_min;
+    hi[l] = T_max;
+    fdf2(p[l], VsS[l], H[l], lo[l], f_lo, df, d2f);
+    fdf2(p[l], VsS[l], H[l], hi[l], f_hi, df, d2f);
+    up[l] = (f_lo > 0);
+    if ((f_hi > 0) == up[l]) {
+      // No root between the physical bounds
+      stat[l] = Dataset::NotConverged;
+      T[l] = -1;
+      active[l] = false;
+      continue;
+    }
+    T[l] = qBound(lo[l], T[l], hi[l]);
+    n_active++;
+  }
+
+  while (n_active > 0) {
+    n_active = 0;
+#ifdef _OPENMP
+    #pragma omp simd private(f, df, d2f, theta) reduction(+:n_active)
+#endif
+    for (int l=0; l < n; l++) {
+      if (!active[l])
+        continue;
+      fdf2(p[l], VsS[l], H[l], T[l], f, df, d2f);
+      if ((f > 0) == up[l])
+        lo[l] = T[l];
+      else
+        hi[l] = T[l];
+      theta = T[l] - 2*f*df/(2*df*df - f*d2f);
+      // Also catches a division by zero, where theta is not finite
+      if (!(theta >= lo[l] && theta <= hi[l]) || steps[l] >= max_halley)
+        theta = 0.5*(lo[l] + hi[l]);
+      active[l] = (f != 0) && (fabs(theta - T[l]) > threshold);
+      T[l] = theta;
+      steps[l]++;
+      n_active += active[l];
+    }
+  }
+}
+
+void TemperatureSolver::convert(int n, const Calibration &p, const double *z,
+                                const double *Vs, const double *P, double *T,
+                                int *stat) const {
+  /**
+  Temperatures T / degC of n points at depth z / m with velocity Vs / km/s
+  and pressure P / Pa, all converted with the parameter set p. stat returns
+  the Dataset::Status of each point, T is -1 where no temperature was found.
+  **/
+  Calibration lanes[Lanes];
+  double VsS[Lanes], H[Lanes];
+  int steps[Lanes];
+  for (int l=0; l < Lanes; l++)
+    lanes[l] = p;
+  for (int i0=0; i0 < n; i0 += Lanes) {
+    int m = qMin(Lanes, n - i0);
+    for (int l=0; l < m; l++) {
+      VsS[l] = corrected(p, Vs[i0 + l], z[i0 + l]);
+      H[l] = activation(p, P[i0 + l]);
+    }
+    temperatures(m, lanes, VsS, H, T + i0, steps, stat + i0);
+  }
+}
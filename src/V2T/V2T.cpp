@@ -29,16 +29,16 @@ V2T::V2T() {
   rho_mantle = 3300;
   rho_avrg = 3100;
   verbose = false;
-  threshold = 0.1;
   scaleZ = 1;
   scaleVs = 1;
-  c_bV = 3.84E-4;  // 1/km
-  c_m  = -2.8E-4;  // km/s
-  c_c  = 4.72;     // km/s
-  c_A  = -1.8E13;  // km/s
-  c_E  = 409.0;    // kJ/mol
-  c_Va = 10E-6;    // m3/mol
-  c_K  = 273.15;
+  Members.append(TemperatureSolver::defaults());
+  EnsembleStats = false;
+  for (int i=0; i < 6; i++)
+    NcSlab[i] = -1;
+  Order = Dataset::FileOrder;
+  Threads = 0;
+  TableSize[0] = 0;
+  TableSize[1] = 0;
 }
 
 void V2T::Info() {
@@ -55,8 +55,21 @@ void V2T::Info() {
        << "Conversion settings\n"
        << "-------------------\n"
        << "Pressure calcuation " << PMethod.toUtf8().data() << endl
-       << "Iteration threshold " << threshold << endl
+       << "Iteration threshold " << Kernel.threshold << endl
+       << "Root finder         "
+       << ((Kernel.Solver == TemperatureSolver::Halley) ? "Halley" : "Newton")
        << endl
+       << "Initial temperature "
+       << ((Kernel.Guess == TemperatureSolver::LambertW) ? "Lambert W"
+                                                         : "1000 degC") << endl
+       << "Threads             " << threads() << endl;
+  if (!File_params.isEmpty())
+    cout << "Parameter sets      " << Members.size() << " from "
+         << File_params.toUtf8().data() << endl;
+  if (TableSize[0] > 0)
+    cout << "Lookup table        " << TableSize[0] << " x " << TableSize[1]
+         << endl;
+  cout << endl
        << "Input\n"
        << "-----\n"
        << "Vs                  " << File_In.toUtf8().data() << endl;
@@ -102,6 +115,8 @@ void V2T::usage() {
        << "  --help                  Extended information\n"
        << "  -ERM      string  AK135 P calculation method AK135, PREM or simple\n"
        << "  -outVs                  Writes VsObs and VsCalc to output file\n"
+       << "  -params   path          Table of parameter sets c_bV c_m c_c c_A c_E\n"
+       << "                          c_Va, one per line, converted in one run\n"
        << "  -rc       val      2890 Crustal density in kg/m3\n"
        << "  -rm       val      3300 Mantle density in kg/m3\n"
        << "  -ra       val      3100 Average density in kg/m3 used in '-ERM simple'\n"
@@ -110,7 +125,21 @@ void V2T::usage() {
        << "  -t_crust  path          EarthVision file for crustal thickness\n"
        << "  -z_topo   path          EarthVision file for topogrpahy\n"
        << "  -t        val       0.1 Threshold for Newton iterations\n"
+       << "  -guess    string lambertw Initial temperature of Newton iteration,\n"
+       << "                          lambertw (closed form) or fixed (1000 degC)\n"
+       << "  -ncvar    name          Variable in NetCDF input, default: first 3D\n"
+       << "  -order    string   file Order of processing the points, file or\n"
+       << "                          morton (Z-order curve, spatially coherent)\n"
+       << "  -slab     i0 i1 j0 j1 k0 k1\n"
+       << "                          Read only this index range from NetCDF input\n"
        << "  -scatter                Use scattered data as input\n"
+       << "  -stats                  With -params, write mean, std, min and max\n"
+       << "                          instead of all temperatures\n"
+       << "  -solver   string halley Root finder, halley (bracketed Halley and\n"
+       << "                          bisection) or newton\n"
+       << "  -table    nVs nP        Interpolate T in a lookup table with nVs x nP\n"
+       << "                          nodes of corrected Vs and pressure\n"
+       << "  -threads  val         0 Number of threads, 0 = all cores\n"
        << "  -v                      For debugging\n"
        << endl
        << endl;
@@ -183,7 +212,7 @@ void V2T::usage_extended() {
 }
 
 bool V2T::test_data() {
-  /// Check minima and maxima of data_Vs, t_crust and z_topo
+  /// Check minima and maxima of data, t_crust and z_topo
   if (use_t_crust && (
       (x_min1 != x_min2) || (x_min2 != x_min3) ||
       (x_max1 != x_max2) || (x_max2 != x_max3) ||
@@ -239,6 +268,12 @@ void V2T::readArgs(int &argc, char *argv[]) {
         WRITE_P(arg[i+1]);
       } else if (arg[i] == "-outVs") {
         outVs = true;
+      } else if (arg[i] == "-params") {
+        File_params = arg[i+1];
+        readParams(File_params);
+        i++;
+      } else if (arg[i] == "-stats") {
+        EnsembleStats = true;
       } else if (arg[i] == "-rc") {
         rho_crust = arg[i+1].toDouble(&ok);
         argsError(arg[i], ok);
@@ -270,10 +305,53 @@ void V2T::readArgs(int &argc, char *argv[]) {
       } else if (arg[i] == "-scatter") {
         ArbitraryPoints = true;
       } else if (arg[i] == "-t") {
-        threshold = arg[i+1].toDouble(&ok);
+        Kernel.threshold = arg[i+1].toDouble(&ok);
         argsError(arg[i], ok);
+      } else if (arg[i] == "-solver") {
+        if (arg[i+1] == "newton") {
+          Kernel.Solver = TemperatureSolver::Newton;
+        } else if (arg[i+1] != "halley") {
+          argsError(arg[i], false);
+        }
+        i++;
+      } else if (arg[i] == "-table") {
+        for (int j=0; j < 2; j++) {
+          TableSize[j] = arg[i+j+1].toInt(&ok);
+          argsError(arg[i], ok && TableSize[j] > 1);
+        }
+        i += 2;
+      } else if (arg[i] == "-threads") {
+        Threads = arg[i+1].toInt(&ok);
+        argsError(arg[i], ok && Threads >= 0);
+        i++;
       } else if (arg[i] == "-v") {
         verbose = true;
+      } else if (arg[i] == "-guess") {
+        if (arg[i+1] == "fixed") {
+          Kernel.Guess = TemperatureSolver::Fixed;
+        } else if (arg[i+1] != "lambertw") {
+          argsError(arg[i], false);
+        }
+        i++;
+      } else if (arg[i] == "-ncvar") {
+        argsError(arg[i], i + 1 < argc);
+        NcVar = arg[i+1];
+        i++;
+      } else if (arg[i] == "-order") {
+        argsError(arg[i], i + 1 < argc);
+        if (arg[i+1] == "morton") {
+          Order = Dataset::Morton;
+        } else if (arg[i+1] != "file") {
+          argsError(arg[i], false);
+        }
+        i++;
+      } else if (arg[i] == "-slab") {
+        argsError(arg[i], i + 6 < argc);
+        for (int j=0; j < 6; j++) {
+          NcSlab[j] = arg[i+j+1].toInt(&ok);
+          argsError(arg[i], ok);
+        }
+        i += 6;
       }
     }
   }
@@ -293,6 +371,11 @@ void V2T::readArgs(int &argc, char *argv[]) {
     }
     exit(1);
   }
+  if (ensemble() && (outVs || TableSize[0] > 0)) {
+    cout << PRINT_ERROR "-outVs and -table can not be used with several "
+            "parameter sets.\n";
+    exit(1);
+  }
   if ((use_t_crust == false) && (ERM->type() == "Undefined")) {
     ERM->set("AK135");
   }
@@ -306,22 +389,36 @@ bool V2T::readFile(QString InName, QString InType) {
 
   okGrid = false;  // Used to check if grid size was extracted from input voxel
 
-  cout << "Reading file: " << InName.toUtf8().data() << endl;
-  QFile file(InName);
+  if (InType == "vox" && NetCDFGrid::isNetCDF(InName))
+    return readNetCDF(InName);
 
-  x_min1 = x_min2 = x_min3 = y_min1 = y_min2 = y_min3 = z_min1 = 1.7E308;
-  x_max1 = x_max2 = x_max3 = y_max1 = y_max2 = y_max3 = z_max1 = -x_min1;
+  cout << "Reading file: " << InName.toUtf8().data() << endl;
+  DataFile file(InName);
+
+  // Reset only the extent of this file, the others have been read before
+  if (InType == "crust") {
+    x_min2 = y_min2 = 1.7E308;
+    x_max2 = y_max2 = -x_min2;
+  } else if (InType == "topo") {
+    x_min3 = y_min3 = 1.7E308;
+    x_max3 = y_max3 = -x_min3;
+  } else {
+    x_min1 = y_min1 = z_min1 = 1.7E308;
+    x_max1 = y_max1 = z_max1 = -x_min1;
+  }
 
   int n = 0;
   if (file.open(QIODevice::ReadOnly)) {
-    QTextStream stream( &file );
+    QTextStream stream(file.device());
 
     while (!stream.atEnd()) {
       n++;
       QString t = stream.readLine().simplified();
 
-      /// Topography or crustal thickness
-      if (!t.startsWith("#") && (InType == "topo" || InType == "crust")) {
+      if (t.isEmpty()) {
+        continue;
+      } else if (!t.startsWith("#") && (InType == "topo" || InType == "crust")) {
+        /// Topography or crustal thickness
         QStringList vals = t.split(" ");
         if (vals.count() != 3) {
           file.close();
@@ -383,6 +480,7 @@ bool V2T::readFile(QString InName, QString InType) {
           exit(1);
         }
         okGrid = true;
+        data.setGrid(nX, nY, nZ);
       } else if (!t.startsWith("#") && InType == "vox") {
         QStringList vals = t.split(" ");
         if (vals.count() != 4) {
@@ -397,8 +495,9 @@ bool V2T::readFile(QString InName, QString InType) {
           val = scaleVs*vals[3].toDouble(&okval);
 
           if (okx && oky && okz && okval) {
-            Point4D p4D(x, y, z, val);
-            data_Vs.append(p4D);
+            if (data.size() == 0 && !data.isRegular())
+              data.reserve(DataFile::countRows(InName));
+            data.append(x, y, z, Dataset::V, val);
           } else {
             file.close();
             cout << PRINT_ERROR "In value conversion line " << n << endl;
@@ -438,6 +537,10 @@ bool V2T::readFile(QString InName, QString InType) {
       ArbitraryPoints = true;
     }
     file.close();
+    if (InType == "crust")
+      CrustIndex.build(t_crust);
+    else if (InType == "topo")
+      TopoIndex.build(z_topo);
     if (vs_min > 10) {
       cout << PRINT_WARNING "Minimum Vs is " << vs_min << " which is unusually "
               "high. Vs must be in km/s. Use -scaleVs to correct.\n";
@@ -448,9 +551,33 @@ bool V2T::readFile(QString InName, QString InType) {
   exit(1);
 }
 
+QStringList V2T::ensembleColumns(QList<int> &cols) {
+  /**
+  Names of the temperature columns written in addition to T (the mean) when
+  several parameter sets were converted, cols returns their indices in
+  data.extra().
+  **/
+  QStringList names;
+  cols.clear();
+  if (!ensemble())
+    return names;
+  if (EnsembleStats) {
+    names << "T_std" << "T_min" << "T_max";
+    cols << 0 << 1 << 2;
+  } else {
+    for (int k=0; k < Members.size(); k++) {
+      names << QString("T_%1").arg(k + 1);
+      cols << 4 + k;
+    }
+  }
+  return names;
+}
+
 bool V2T::saveFile(QString OutName) {
   QString T_header;
   QString T_info;
+  QList<int> cols;
+  QStringList names = ensembleColumns(cols);
   // Get timestamp
   QDateTime CurrentTime = QDateTime::currentDateTime();
   QString timefmt = "yyyy-MM-dd hh:mm:ss";
@@ -458,16 +585,22 @@ bool V2T::saveFile(QString OutName) {
   // General information string
   T_info = QString("# Created: %1\n").arg(timestamp);
   T_info += QString("# Input: %1\n").arg(File_In);
-  T_info += QString("# Newton threshold: %1\n").arg(threshold, 0, 'f');
+  T_info += QString("# Newton threshold: %1\n").arg(Kernel.threshold, 0, 'f');
   T_info += QString("# z-factor: %1\n").arg(scaleZ, 0, 'f');
   T_info += QString("# Vs-factor: %1\n").arg(scaleVs, 0, 'f');
   T_info += QString("# Pressure calculation method: %1\n").arg(PMethod);
+  if (!File_params.isEmpty()) {
+    T_info += QString("# Parameter sets: %1 from %2\n").arg(Members.size())
+                                                        .arg(File_params);
+  }
   if (PMethod == "simple") {
     T_info += QString("# Average density: %1 kg/m3\n").arg(rho_avrg, 0, 'f');
   } else if (PMethod == "crust") {
     T_info += QString("# Density crust: %1 kg/m3\n").arg(rho_crust, 0, 'f');
-    T_info += QString("# Density mantle: %1 kg/m3").arg(rho_mantle, 0, 'f');
+    T_info += QString("# Density mantle: %1 kg/m3\n").arg(rho_mantle, 0, 'f');
   }
+  if (NetCDFGrid::isNetCDF(OutName))
+    return saveNetCDF(OutName, T_info);
   // GMS compatible file
   if (!ArbitraryPoints) {
     T_header =  QString("# Type: GMS GridPoints\n"
@@ -482,6 +615,8 @@ bool V2T::saveFile(QString OutName) {
       T_header += QString("# Field: 4 VsObs / degC\n"
                           "# Field: 5 VsCalc / degC\n");
     }
+    for (int k=0; k < names.size(); k++)
+      T_header += QString("# Field: %1 %2 / degC\n").arg(k + 5).arg(names[k]);
     T_header += QString("# Projection: Local Rectangular\n");
     T_header += QString("# Information from grid:\n");
     T_header += QString("# Grid_size: %1 x %2 x %3\n").arg(nX).arg(nY).arg(nZ);
@@ -504,11 +639,13 @@ bool V2T::saveFile(QString OutName) {
       T_header += QString("# 5 - VsObs / degC\n"
                           "# 6 - VsCalc / degC\n");
     }
+    for (int k=0; k < names.size(); k++)
+      T_header += QString("# %1 - %2 / degC\n").arg(k + 5).arg(names[k]);
     T_header += T_info;
   }
 
   cout << "Writing temperature file " << OutName.toUtf8().data() << endl;
-  QFile tmp(OutName);
+  DataFile tmp(OutName);
 
   if (!tmp.open(QIODevice::WriteOnly | QIODevice::Text)) {
     cout << PRINT_ERROR "Could not open file " << OutName.toUtf8().data()
@@ -516,27 +653,184 @@ bool V2T::saveFile(QString OutName) {
     exit(1);
   }
 
-  QTextStream out(&tmp);
+  QTextStream out(tmp.device());
   out.setRealNumberPrecision(2);
   out.setFieldAlignment(QTextStream::AlignRight);
   out.setRealNumberNotation(QTextStream::FixedNotation);
   out << T_header.toUtf8().data();
-  for (int i=0; i < data_T.length(); i++) {
-    out << data_T[i].x() << "\t"
-        << data_T[i].y() << "\t"
-        << data_T[i].z() << "\t";
+  const double *Vs = data.column(Dataset::V);
+  const double *T = data.column(Dataset::T);
+  const double *VsCalc = data.column(Dataset::VCalc);
+  for (int i=0; i < data.size(); i++) {
+    out << data.x(i) << "\t"
+        << data.y(i) << "\t"
+        << data.z(i) << "\t";
     out.setRealNumberPrecision(1);
-    out << data_T[i].v();
+    out << T[i];
+    for (int k=0; k < cols.size(); k++)
+      out << "\t" << data.extra(cols[k])[i];
     if (outVs) {
       out.setRealNumberPrecision(3);
-      out << "\t" << data_Vs[i].v() << "\t"
-          << data_Vcalc[i];
+      out << "\t" << Vs[i] << "\t"
+          << VsCalc[i];
     }
     out.setRealNumberPrecision(2);
     out << endl;
   }
 
-  tmp.close();
+  out.flush();
+  return tmp.close();
+}
+
+bool V2T::readParams(QString FileName) {
+  /**
+  Reads the parameter sets of an ensemble. Every line holds c_bV / 1/km,
+  c_m / km/s/degC, c_c / km/s, c_A / km/s, c_E / kJ/mol and c_Va / m3/mol of
+  one set, lines starting with # are comments.
+  **/
+  DataFile file(FileName);
+  if (!file.open(QIODevice::ReadOnly)) {
+    cout << PRINT_ERROR "Could not open file " << FileName.toUtf8().data()
+         << endl;
+    exit(1);
+  }
+  QTextStream stream(file.device());
+  Members.clear();
+  int n = 0;
+  while (!stream.atEnd()) {
+    n++;
+    QString t = stream.readLine().simplified();
+    if (t.isEmpty() || t.startsWith("#"))
+      continue;
+    QStringList vals = t.split(" ");
+    bool ok = (vals.count() == 6);
+    double c[6];
+    for (int k=0; ok && k < 6; k++)
+      c[k] = vals[k].toDouble(&ok);
+    if (!ok) {
+      file.close();
+      cout << PRINT_ERROR "Expected 6 parameters in line " << n << " of "
+           << FileName.toUtf8().data() << endl;
+      exit(1);
+    }
+    Calibration p;
+    p.bV = c[0];
+    p.m = c[1];
+    p.c = c[2];
+    p.A = c[3];
+    p.E = c[4];
+    p.Va = c[5];
+    Members.append(p);
+  }
+  file.close();
+  if (Members.isEmpty()) {
+    cout << PRINT_ERROR "No parameter sets in " << FileName.toUtf8().data()
+         << endl;
+    exit(1);
+  }
+  return true;
+}
+
+bool V2T::readNetCDF(QString InName) {
+  /**
+  Reads the S-wave velocity volume from a NetCDF file. Only the hyperslab given
+  by -slab is loaded, nodes with missing values are skipped.
+  **/
+  NetCDFGrid grid;
+  double x, y, z, val;
+  double vs_min = -1;
+
+  cout << "Reading file: " << InName.toUtf8().data() << endl;
+  grid.setSlab(NcSlab[0], NcSlab[1], NcSlab[2], NcSlab[3], NcSlab[4],
+               NcSlab[5]);
+  if (!grid.read(InName, NcVar)) {
+    cout << PRINT_ERROR "In " << InName.toUtf8().data() << ": "
+         << grid.error().toUtf8().data() << endl;
+    exit(1);
+  }
+
+  x_min1 = y_min1 = z_min1 = 1.7E308;
+  x_max1 = y_max1 = z_max1 = -x_min1;
+  data.setGrid(grid.nX(), grid.nY(), grid.nZ());
+  for (int n=0; n < grid.size(); n++) {
+    if (std::isnan(grid.value(n)))
+      continue;
+    x = grid.x(n);
+    y = grid.y(n);
+    z = scaleZ*grid.z(n);
+    val = scaleVs*grid.value(n);
+    data.append(x, y, z, Dataset::V, val);
+
+    x_min1 = std::min(x_min1, x);
+    x_max1 = std::max(x_max1, x);
+    y_min1 = std::min(y_min1, y);
+    y_max1 = std::max(y_max1, y);
+    z_min1 = std::min(z_min1, z);
+    z_max1 = std::max(z_max1, z);
+    if (vs_min == -1 || val < vs_min)
+      vs_min = val;
+  }
+  nX = grid.nX();
+  nY = grid.nY();
+  nZ = grid.nZ();
+  if (data.size() < grid.size()) {
+    cout << PRINT_WARNING << grid.size() - data.size() << " nodes without "
+            "value. Set output to scattered data.\n";
+    ArbitraryPoints = true;
+  }
+  if (vs_min > 10) {
+    cout << PRINT_WARNING "Minimum Vs is " << vs_min << " which is unusually "
+            "high. Vs must be in km/s. Use -scaleVs to correct.\n";
+  }
+  return true;
+}
+
+bool V2T::saveNetCDF(QString OutName, QString T_info) {
+  NetCDFGrid grid;
+  QVector<double> x, y, z;
+  QList<NetCDFVariable> vars;
+  NetCDFVariable T, VsObs, VsCalc;
+
+  T.name = "T";
+  T.long_name = "Temperature";
+  T.units = "degC";
+  VsObs.name = "VsObs";
+  VsObs.long_name = "Observed S-wave velocity";
+  VsObs.units = "km/s";
+  VsCalc.name = "VsCalc";
+  VsCalc.long_name = "S-wave velocity at calculated temperature";
+  VsCalc.units = "km/s";
+  for (int i=0; i < data.size(); i++) {
+    x.append(data.x(i));
+    y.append(data.y(i));
+    z.append(data.z(i));
+  }
+  T.vals = data.column(Dataset::T);
+  VsObs.vals = data.column(Dataset::V);
+  VsCalc.vals = data.column(Dataset::VCalc);
+  vars.append(T);
+  if (outVs) {
+    vars.append(VsObs);
+    vars.append(VsCalc);
+  }
+  QList<int> cols;
+  QStringList names = ensembleColumns(cols);
+  for (int k=0; k < cols.size(); k++) {
+    NetCDFVariable member = T;
+    member.name = names[k];
+    member.long_name = EnsembleStats ? names[k].mid(2) + " of temperature"
+                                     : "Temperature, parameter set "
+                                       + names[k].mid(2);
+    member.vals = data.extra(cols[k]);
+    vars.append(member);
+  }
+
+  cout << "Writing temperature file " << OutName.toUtf8().data() << endl;
+  if (!grid.write(OutName, x, y, z, vars, T_info.remove("# "))) {
+    cout << PRINT_ERROR "Could not write " << OutName.toUtf8().data() << ": "
+         << grid.error().toUtf8().data() << endl;
+    exit(1);
+  }
   return true;
 }
 
@@ -557,26 +851,6 @@ bool V2T::SetPMethod(QString method) {
   return true;
 }
 
-double V2T::ftheta(double VsS, double P, double T) {
-  /**
-  VsS Corrected velocity / km/s
-  P   Pressure           / Pa
-  T   Temperature        / degC
-  **/
-  return c_m*T - VsS + c_c + c_A*exp(-(c_E*1000 + P*c_Va)/c_R/(T + c_K));
-}
-
-double V2T::dfdtheta(double P, double T) {
-  /**
-  Derivative of Temperature function (d Theta / d T)
-  Priestley and McKenzie (2006), Eqn 5
-  P   Pressure    / Pa
-  T   Temperature / degC
-  **/
-  return c_m + c_A*(c_E*1000 + P*c_Va)/c_R/(pow(T + c_K, 2))*
-         exp(-(c_E*1000 + P*c_Va)/c_R/(T + c_K));
-}
-
 double V2T::pressure(double x, double y, double z) {
   /**
   Call the appropriate function based on the selected pressure calculation
@@ -602,21 +876,20 @@ double V2T::pressure_crust(double x, double y, double z) {
   rho_mantle    Mantle density
   **/
 
-  int i_crust, i_topo, i;
+  int i_crust, i_topo;
   double P_crust, t_mantle, P_mantle;
 
   // Get index in data_t_crust and data_z_topo
-  i = 0;
-  while ((t_crust[i].x() != x) && (t_crust[i].y() != y))
-    i++;
-  i_crust = i;
-  i = 0;
-  while ((z_topo[i].x() != x) && (z_topo[i].y() != y))
-    i++;
-  i_topo=i;
-
-  P_crust = rho_crust*c_g*t_crust[i_crust].z();              // P from crust
-  t_mantle = z_topo[i_topo].z() - t_crust[i_crust].z() - z;  // Thickness mantle
+  i_crust = CrustIndex.find(x, y);
+  i_topo = TopoIndex.find(x, y);
+  if (i_crust < 0 || i_topo < 0) {
+    cout << PRINT_ERROR "No crustal thickness or topography at x = " << x
+         << ", y = " << y << endl;
+    exit(1);
+  }
+
+  P_crust = rho_crust*c_g*t_crust.at(i_crust).z();           // P from crust
+  t_mantle = z_topo.at(i_topo).z() - t_crust.at(i_crust).z() - z;  // Mantle
 
   if (t_mantle < 0) {
     cout << "Error: Mantle thickness < 0\nExit\n";
@@ -633,6 +906,122 @@ double V2T::pressure_simple(double z) {
   return rho_avrg*c_g*fabs(z);
 }
 
+int V2T::threads() {
+  // Number of threads used by newton()
+#ifdef _OPENMP
+  if (verbose)
+    return 1;
+  return (Threads > 0) ? Threads : omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+void V2T::buildTable(double VsS_min, double VsS_max, double P_min,
+                     double P_max) {
+  /**
+  Tabulates the temperature on TableSize[0] x TableSize[1] nodes of corrected
+  velocity and pressure, which are later interpolated bilinearly by
+  lookup(). Nodes without temperature are stored as NaN. The interpolation
+  error is estimated against the Newton solution at the cell centres, where
+  it is largest.
+  **/
+  int nV = TableSize[0];
+  int nP = TableSize[1];
+
+  // Velocities >= 4.4 km/s are converted with the linear relation
+  VsS_max = qMin(VsS_max, 4.4 - 1e-9);
+  if (VsS_max <= VsS_min)
+    VsS_max = VsS_min + 1e-3;
+  if (P_max <= P_min)
+    P_max = P_min + 1;
+  TableVsS[0] = VsS_min;
+  TableVsS[1] = (VsS_max - VsS_min)/(nV - 1);
+  TableP[0] = P_min;
+  TableP[1] = (P_max - P_min)/(nP - 1);
+  Table.resize(nV*nP);
+  TableError = 0;
+
+  cout << "Building lookup table with " << nV << " x " << nP << " nodes\n";
+#ifdef _OPENMP
+  #pragma omp parallel for num_threads(threads())
+#endif
+  for (int k=0; k < nP; k++) {
+    Calibration p[Lanes];
+    double VsS[Lanes], H[Lanes], T[Lanes];
+    int steps[Lanes], stat[Lanes];
+    for (int i0=0; i0 < nV; i0 += Lanes) {
+      int m = qMin(Lanes, nV - i0);
+      for (int l=0; l < m; l++) {
+        p[l] = Members[0];
+        VsS[l] = TableVsS[0] + (i0 + l)*TableVsS[1];
+        H[l] = TemperatureSolver::activation(p[l], TableP[0] + k*TableP[1]);
+      }
+      Kernel.temperatures(m, p, VsS, H, T, steps, stat);
+      for (int l=0; l < m; l++)
+        Table[k*nV + i0 + l] = (stat[l] == Dataset::Ok) ? T[l] : NAN;
+    }
+  }
+
+  // Error at the cell centres
+  double error = 0;
+#ifdef _OPENMP
+  #pragma omp parallel for num_threads(threads()) reduction(max:error)
+#endif
+  for (int k=0; k < nP - 1; k++) {
+    Calibration p[Lanes];
+    double VsS[Lanes], H[Lanes], P[Lanes], T[Lanes];
+    int steps[Lanes], stat[Lanes];
+    for (int i0=0; i0 < nV - 1; i0 += Lanes) {
+      int m = qMin(Lanes, nV - 1 - i0);
+      for (int l=0; l < m; l++) {
+        p[l] = Members[0];
+        VsS[l] = TableVsS[0] + (i0 + l + 0.5)*TableVsS[1];
+        P[l] = TableP[0] + (k + 0.5)*TableP[1];
+        H[l] = TemperatureSolver::activation(p[l], P[l]);
+      }
+      Kernel.temperatures(m, p, VsS, H, T, steps, stat);
+      for (int l=0; l < m; l++) {
+        double T_table = lookup(VsS[l], P[l]);
+        if (stat[l] == Dataset::Ok && !std::isnan(T_table))
+          error = qMax(error, fabs(T_table - T[l]));
+      }
+    }
+  }
+  TableError = error;
+  cout << "VsS " << VsS_min << " to " << VsS_max << " km/s, P " << P_min
+       << " to " << P_max << " Pa\n"
+       << "Maximum interpolation error " << TableError << " degC\n";
+}
+
+double V2T::lookup(double VsS, double P) {
+  /**
+  Bilinear interpolation of the temperature in the lookup table, NaN if a
+  node of the cell has no temperature. Points outside of the table are
+  extrapolated from the closest cell.
+  **/
+  int nV = TableSize[0];
+  int nP = TableSize[1];
+  double u = (VsS - TableVsS[0])/TableVsS[1];
+  double v = (P - TableP[0])/TableP[1];
+  int i = qBound(0, static_cast<int>(floor(u)), nV - 2);
+  int k = qBound(0, static_cast<int>(floor(v)), nP - 2);
+  u -= i;
+  v -= k;
+  const double *t = Table.constData() + k*nV + i;
+  return (1 - v)*((1 - u)*t[0] + u*t[1]) + v*((1 - u)*t[nV] + u*t[nV + 1]);
+}
+
+void V2T::prepare(int i, double &VsS, double &P) {
+  /**
+  Corrected velocity VsS / km/s with the first parameter set and pressure
+  P / Pa of point i in data
+  **/
+  double z = data.z(i);  // z in m
+  VsS = TemperatureSolver::corrected(Members[0], data.column(Dataset::V)[i], z);
+  P = pressure(data.x(i), data.y(i), z);
+}
+
 bool V2T::newton() {
   /**
   In this function the calculation of the temperature is performed. We want to
@@ -650,114 +1039,260 @@ bool V2T::newton() {
   Theta_i+1 = Theta_i - f(Theta_i)/f'(Theta_i)
 
   where f' = df/dTheta
-  **/
-  int count_zero, count_fail, n, j, progress;
-  double Vs, x, y, z, VsS, theta_init, theta_i1, theta_i2, P, delta_theta,
-         numerator, denominator;
-  Point4D p4D;
 
-  n = data_Vs.length();
+  The points are independent of each other. With OpenMP they are distributed
+  in blocks over the threads, which write into the preallocated columns of
+  data. Failures are counted per thread and summed up at the end.
+
+  If a lookup table was requested (-table), the temperatures are interpolated
+  from the table. Points in cells with a node without temperature are solved
+  by Newton iteration.
 
-  // Start to iterate every Vs in data_Vs
+  With several parameter sets (-params) every point is converted with each
+  set. Pressure is computed once per point, the sets are solved side by side
+  in the lanes of temperatures(). T becomes the mean over the sets with a
+  temperature, the extra columns of data hold standard deviation, minimum,
+  maximum, count and, unless only statistics are written, the temperature of
+  every set.
+  **/
+  const int block = 4096;  // Points per work unit of a thread
+  int n, n_blocks, n_done, n_zero, n_fail, progress;
+
+  n = data.size();
+  data.allocate();
+  const int *order = data.order(Order);
+  const double *Vs_obs = data.column(Dataset::V);
+  double *T_out = data.column(Dataset::T);
+  double *Vs_calc = data.column(Dataset::VCalc);
+  int *steps = data.iterations();
+  int *status = data.status();
+
+  // Start to iterate every Vs in data
   cout << endl
        << "********************************\n"
        << "Starting temperature calculation\n"
        << "********************************\n";
 
-  count_zero = 0;   // Counts amount of zero-divisions in Newtonian iterations
-  count_fail = 0;   // Counts how often solution could not be found
-  j = 0;
+  if (TableSize[0] > 0) {
+    double VsS_min = INFINITY, VsS_max = -INFINITY;
+    double P_min = INFINITY, P_max = -INFINITY;
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(threads()) \
+            reduction(min:VsS_min, P_min) reduction(max:VsS_max, P_max)
+#endif
+    for (int i=0; i < n; i++) {
+      double VsS, P;
+      prepare(i, VsS, P);
+      VsS_min = qMin(VsS_min, VsS);
+      VsS_max = qMax(VsS_max, VsS);
+      P_min = qMin(P_min, P);
+      P_max = qMax(P_max, P);
+    }
+    buildTable(VsS_min, VsS_max, P_min, P_max);
+  }
+
+  // Ensemble: running mean in T_out, statistics in the extra columns
+  int K = Members.size();
+  double *T_std = 0, *T_min = 0, *T_max = 0, *T_count = 0;
+  if (ensemble()) {
+    data.allocateExtra(4 + (EnsembleStats ? 0 : K));
+    T_std = data.extra(0);    // Sum of squared deviations until the end
+    T_min = data.extra(1);
+    T_max = data.extra(2);
+    T_count = data.extra(3);  // Number of members with a temperature
+    for (int i=0; i < n; i++) {
+      T_out[i] = 0;
+      T_std[i] = 0;
+      T_min[i] = INFINITY;
+      T_max[i] = -INFINITY;
+      T_count[i] = 0;
+    }
+  }
 
-  for (int i=0; i < n; i++) {
-    // Read data
-    Vs = data_Vs[i].v();
-    x = data_Vs[i].x();
-    y = data_Vs[i].y();
-    z = data_Vs[i].z();  // z in m
-
-    // Calculate Vs* [km/s]
-    // See Priestley and McKenzie (2006), Eqn 3
-    VsS = Vs/(1+c_bV*(fabs(z)/1000.0 - 50.0));
-    // Calculate pressure [Pa]
-    P = pressure(x, y, z);
-
-    // See Priestley and McKenzie (2006), Eqn 10
-    if (VsS < 4.4) {
-      theta_init = 1000.0;
-      // Calculate initial T estimate theta_i0 and derivative theta_i0_d
-      theta_i1 = theta_init
-                 - ftheta(VsS, P, theta_init)/dfdtheta(P, theta_init);
-
-      // Start Newton iteration
-      delta_theta = threshold + 1;
-      j = 0;
-      while (delta_theta > threshold) {
-        numerator = ftheta(VsS, P, theta_i1);
-        denominator = dfdtheta(P, theta_i1);
-
-        if (denominator == 0) {
-          // If denominator = 0, add 1 to counter and continue with next value
-          count_zero += 1;
-          theta_i1 = -1;
-          break;
+  n_blocks = (n + block - 1)/block;
+  n_done = 0;
+  n_zero = 0;
+  n_fail = 0;
+  progress = -1;
+#ifdef _OPENMP
+  #pragma omp parallel for schedule(dynamic) num_threads(threads()) \
+          reduction(+:n_zero, n_fail)
+#endif
+  for (int b=0; b < n_blocks; b++) {
+    int k_end = qMin(n, (b + 1)*block);
+    Calibration p[Lanes];
+    double VsS[Lanes], P[Lanes], H[Lanes], theta[Lanes];
+    int j[Lanes], stat[Lanes], point[Lanes], member[Lanes];
+    int m = 0;
+    int k_last = -1;
+    double P_last = 0;
+
+    // Every point is converted with each of the K parameter sets, the pairs
+    // of point and set are solved Lanes at a time
+    for (int q=b*block*K; q < k_end*K; q++) {
+      int k = q/K;
+      int i = order[k];
+      if (k != k_last) {
+        // Pressure is the same for all parameter sets
+        P_last = pressure(data.x(i), data.y(i), data.z(i));
+        k_last = k;
+      }
+      point[m] = i;
+      member[m] = q % K;
+      p[m] = Members[member[m]];
+      VsS[m] = TemperatureSolver::corrected(p[m], Vs_obs[i], data.z(i));
+      P[m] = P_last;
+      H[m] = TemperatureSolver::activation(p[m], P[m]);
+      m++;
+      if (m < Lanes && q < k_end*K - 1)
+        continue;
+
+      if (TableSize[0] > 0) {
+        bool solve = false;
+        for (int l=0; l < m; l++) {
+          j[l] = 0;
+          stat[l] = Dataset::Ok;
+          theta[l] = (VsS[l] >= 4.4) ? (VsS[l]-p[l].c)/p[l].m
+                                     : lookup(VsS[l], P[l]);
+          solve = solve || std::isnan(theta[l]);
+        }
+        if (solve) {
+          double T[Lanes];
+          int j_T[Lanes], stat_T[Lanes];
+          Kernel.temperatures(m, p, VsS, H, T, j_T, stat_T);
+          for (int l=0; l < m; l++) {
+            if (std::isnan(theta[l])) {
+              theta[l] = T[l];
+              j[l] = j_T[l];
+              stat[l] = stat_T[l];
+            }
+          }
         }
+      } else {
+        Kernel.temperatures(m, p, VsS, H, theta, j, stat);
+      }
 
-        theta_i2 = theta_i1 - numerator/denominator;
-        delta_theta = fabs(theta_i2 - theta_i1);
-        theta_i1 = theta_i2;
+      for (int l=0; l < m; l++) {
+        int i = point[l];
+        double x = data.x(i);
+        double y = data.y(i);
+        double z = data.z(i);
+        if (stat[l] == Dataset::ZeroDivision) {
+          n_zero++;
+        } else if (stat[l] == Dataset::NotConverged) {
+          n_fail++;
+#ifdef _OPENMP
+          #pragma omp critical(output)
+#endif
+          {
+            printf("\r" PRINT_WARNING "Too many iterations!\n");
+            printf("Coordinates: %f, %f, %f, Vs: %f\n",x,y,z,Vs_obs[i]);
+          }
+        }
 
-        j++;
+        if (verbose) {
+          cout << endl
+               << "Point #" << i << endl;
+          if (ensemble())
+            cout << "Parameter set                              " << member[l]
+                 << endl;
+          cout << "Depth                       z       / m    " << z << endl
+               << "Pressure                    P       / Pa   " << P[l] << endl
+               << "S-Wave velocity             Vs      / km/s " << Vs_obs[i]
+               << endl
+               << "S-Wave velocity, corrected  VsS     / km/s " << VsS[l]
+               << endl
+               << "Calculated temperature      theta_i / degC " << theta[l]
+               << endl
+               << "Iteration steps                            " << j[l] << endl
+               << endl;
+        }
 
-        if (j > 10000) {
-          printf("\r" PRINT_WARNING "Too many iterations!\n");
-          printf("Coordinates: %f, %f, %f, Vs: %f\n",x,y,z,Vs);
-          count_fail += 1;
-          theta_i1 = -1;
-          break;
+        if (ensemble()) {
+          // All sets of a point are handled by this thread, in order
+          steps[i] = qMax(steps[i], j[l]);
+          if (!EnsembleStats)
+            data.extra(4 + member[l])[i] = theta[l];
+          if (stat[l] != Dataset::Ok) {
+            status[i] = stat[l];
+            continue;
+          }
+          // Welford's update of mean and sum of squared deviations
+          T_count[i] += 1;
+          double delta = theta[l] - T_out[i];
+          T_out[i] += delta/T_count[i];
+          T_std[i] += delta*(theta[l] - T_out[i]);
+          T_min[i] = qMin(T_min[i], theta[l]);
+          T_max[i] = qMax(T_max[i], theta[l]);
+          continue;
+        }
+
+        // Write estimated temperature to final table
+        T_out[i] = theta[l];
+        steps[i] = j[l];
+        status[i] = stat[l];
+
+        // Calculate synthetic velocity from temperature
+        if (outVs) {
+          double VsSCalc = p[l].m*theta[l] + p[l].c
+                           + p[l].A*exp(-H[l]/(theta[l] + Kernel.c_K));
+          double VsCalc = VsSCalc*(1 + p[l].bV*(fabs(z)/1000 - 50));
+          Vs_calc[i] = VsCalc;
         }
       }
-      if (verbose){
-        cout << "Estimated temperature " << theta_i1 << endl
-             << "delta_theta           " << delta_theta << endl
-             << "Iteration steps       " << j << endl << endl;
-      }
-    } else {
-      theta_i1 = (VsS-c_c)/c_m;
+      m = 0;
     }
 
-    if (verbose) {
-      cout << endl
-           << "Point #" << i << endl
-           << "Depth                       z       / m    " << z << endl
-           << "Pressure                    P       / Pa   " << P << endl
-           << "S-Wave velocity             Vs      / km/s " << Vs << endl
-           << "S-Wave velocity, corrected  VsS     / km/s " << VsS << endl
-           << "Calculated temperature      theta_i / degC " << theta_i1 << endl
-           << endl;
-    } else {
-      progress = static_cast<int>(
-                 round(static_cast<double>(i)/static_cast<double>(n))*100.0);
-      if (progress % 5 == 0) {
-        printf("\rProgress: %i       ", progress);
+    // Progress is reported per block, by whichever thread finishes one
+    if (!verbose) {
+#ifdef _OPENMP
+      #pragma omp critical(output)
+#endif
+      {
+        n_done += k_end - b*block;
+        int percent = static_cast<int>(100.0*n_done/n);
+        if (percent/5 != progress/5) {
+          progress = percent;
+          printf("\rProgress: %i       ", progress);
+          fflush(stdout);
+        }
       }
     }
+  }
+  cout << endl << endl;
 
-    // Write estimated temperature to final table
-    p4D.setV(theta_i1);
-    p4D.setX(x);
-    p4D.setY(y);
-    p4D.setZ(z);
-    data_T.append(p4D);
+  if (ensemble()) {
+    for (int i=0; i < n; i++) {
+      if (T_count[i] == 0) {
+        T_out[i] = T_std[i] = T_min[i] = T_max[i] = -1;
+      } else {
+        T_std[i] = (T_count[i] > 1) ? sqrt(T_std[i]/(T_count[i] - 1)) : 0;
+      }
+    }
+  }
 
-    // Calculate synthetic velocity from temperature
-    if (outVs) {
-      double VsSCalc = c_m*theta_i1 + c_c
-                       + c_A*exp(-(c_E*1000 + P*c_Va)/c_R/(theta_i1 + c_K));
-      double VsCalc = VsSCalc*(1 + c_bV*(fabs(z)/1000 - 50));
-      data_Vcalc.append(VsCalc);
+  // Histogram of the iteration steps of points that were iterated
+  QVector<int> histogram(12, 0);  // 1 to 10 steps, > 10 steps
+  for (int i=0; i < n; i++) {
+    if (steps[i] > 0)
+      histogram[qMin(steps[i], 11)]++;
+  }
+  cout << "Iteration steps     Points\n";
+  for (int s=1; s < 12; s++) {
+    if (histogram[s] > 0) {
+      printf("%17s %8i\n", (s < 11) ? QString::number(s).toUtf8().data()
+                                     : "> 10", histogram[s]);
     }
   }
-  cout << endl << endl;
+  cout << endl;
+
+  if (n_zero + n_fail) {
+    cout << PRINT_WARNING "No temperature (T = -1) at " << n_zero
+         << " points due to zero division, " << n_fail
+         << " points did not converge.\n";
+    if (ensemble())
+      cout << "Points are counted once per parameter set.\n";
+  }
   return true;
 }
 
@@ -813,20 +1348,3 @@ void V2T::WRITE_P(QString method) {
 //##############################################################################
 // Code
 //##############################################################################
-int main(int argc, char *argv[]) {
-  V2T VelTemp;
-  if (argc > 0) {
-    VelTemp.readArgs(argc, argv);
-    VelTemp.Info();
-    VelTemp.readFile(VelTemp.FileIn(), "vox");
-    if (VelTemp.UseCrust()) {
-      VelTemp.readFile(VelTemp.FileTCrust(), "crust");
-      VelTemp.readFile(VelTemp.FileZTopo(), "topo");
-    }
-    VelTemp.test_data();
-    VelTemp.newton();
-    VelTemp.saveFile(VelTemp.FileOut());
-  } else {
-    VelTemp.usage();
-  }
-}
@@ -23,8 +23,17 @@ CONFIG -= app_bundle
 INCLUDEPATH += ../../include/common ../../include/V2T
 
 LIBS += -L../common -lcommon
+netcdf {
+  LIBS += -lnetcdf
+}
+# OpenMP parallelises the conversion, disable with 'qmake CONFIG+=no_openmp'
+!no_openmp {
+  QMAKE_CXXFLAGS += -fopenmp
+  QMAKE_LFLAGS += -fopenmp
+}
 
-SOURCES += V2T.cpp
+SOURCES += main.cpp V2T.cpp TemperatureSolver.cpp
 
-HEADERS += V2T.h
+HEADERS += ../../include/V2T/V2T.h \
+           ../../include/V2T/TemperatureSolver.h
 
@@ -0,0 +1,73 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#include "Arena.h"
+#include <stdlib.h>
+#include <iostream>
+#include "ANSIICodes.h"
+
+static const size_t Align = 64;   // Cache line, also suits SIMD loads
+
+static size_t alignUp(size_t n) {
+  return (n + Align - 1) & ~(Align - 1);
+}
+
+Arena::Arena(size_t blockSize) {
+  BlockSize = blockSize;
+}
+
+Arena::~Arena() {
+  for (int i=0; i < Blocks.size(); i++)
+    free(Blocks[i].data);
+}
+
+void *Arena::allocate(size_t bytes) {
+  bytes = alignUp(bytes > 0 ? bytes : 1);
+  if (Blocks.isEmpty() || Blocks.last().size - Blocks.last().used < bytes) {
+    Block b;
+    b.size = alignUp(bytes > BlockSize ? bytes : BlockSize);
+    b.used = 0;
+    if (posix_memalign(reinterpret_cast<void **>(&b.data), Align, b.size)) {
+      std::cout << PRINT_ERROR "Out of memory, could not allocate " << b.size
+                << " bytes." << std::endl;
+      exit(1);
+    }
+    Blocks.append(b);
+  }
+  Block &b = Blocks.last();
+  void *p = b.data + b.used;
+  b.used += bytes;
+  return p;
+}
+
+bool Arena::extend(void *p, size_t oldBytes, size_t newBytes) {
+  /**
+  Grows the allocation p from oldBytes to newBytes without moving it. This is
+  only possible for the most recent allocation if its block has room left.
+  **/
+  if (Blocks.isEmpty())
+    return false;
+  Block &b = Blocks.last();
+  char *end = b.data + b.used;
+  if (static_cast<char *>(p) + alignUp(oldBytes) != end)
+    return false;
+  size_t used = b.used - alignUp(oldBytes) + alignUp(newBytes);
+  if (used > b.size)
+    return false;
+  b.used = used;
+  return true;
+}
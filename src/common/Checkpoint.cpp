@@ -0,0 +1,140 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#include "Checkpoint.h"
+#include <string.h>
+
+namespace {
+const char Magic[8] = {'V', 'D', 'T', 'C', 'K', 'P', 'T', '1'};
+const int HeaderSize = sizeof(Magic) + sizeof(qint32);
+}
+
+Checkpoint::Checkpoint(QString FileName) : File(FileName) {
+  Failed = false;
+  End = 0;
+}
+
+void Checkpoint::write(const char *data, qint64 size) {
+  if (File.write(data, size) != size)
+    Failed = true;
+}
+
+bool Checkpoint::start(const QByteArray &signature) {
+  // Starts a new file, an existing one is overwritten
+  File.close();
+  if (!File.open(QIODevice::WriteOnly)) {
+    Error = "Could not open " + File.fileName();
+    return false;
+  }
+  qint32 size = signature.size();
+  Failed = false;
+  write(Magic, sizeof(Magic));
+  write(reinterpret_cast<const char *>(&size), sizeof(size));
+  write(signature.constData(), size);
+  return flush();
+}
+
+bool Checkpoint::read(const QByteArray &signature, QList<int> &units,
+                      QList<QByteArray> &records) {
+  /**
+  Reads the records of a run with the same signature into units and records.
+  A partial record at the end is ignored.
+  **/
+  File.close();
+  if (!File.open(QIODevice::ReadOnly)) {
+    Error = "Could not open " + File.fileName();
+    return false;
+  }
+  char magic[sizeof(Magic)];
+  qint32 size = -1;
+  if (File.read(magic, sizeof(magic)) != sizeof(magic)
+      || memcmp(magic, Magic, sizeof(Magic)) != 0
+      || File.read(reinterpret_cast<char *>(&size), sizeof(size))
+         != sizeof(size)
+      || size < 0) {
+    File.close();
+    Error = File.fileName() + " is no checkpoint file";
+    return false;
+  }
+  QByteArray stored(size, '\0');
+  if (File.read(stored.data(), size) != size || stored != signature) {
+    File.close();
+    Error = File.fileName() + " belongs to a run with other input or settings";
+    return false;
+  }
+
+  End = HeaderSize + size;
+  qint32 head[2];  // Unit, size of the record
+  while (File.read(reinterpret_cast<char *>(head), sizeof(head))
+         == sizeof(head)) {
+    if (head[1] < 0)
+      break;
+    QByteArray record(head[1], '\0');
+    if (File.read(record.data(), head[1]) != head[1])
+      break;
+    units.append(head[0]);
+    records.append(record);
+    End += sizeof(head) + head[1];
+  }
+  File.close();
+  return true;
+}
+
+bool Checkpoint::resume(const QByteArray &signature, QList<int> &units,
+                        QList<QByteArray> &records) {
+  // read() and append to the file after the last complete record, a partial
+  // record at the end is cut off
+  if (!read(signature, units, records))
+    return false;
+  if (!File.resize(End)
+      || !File.open(QIODevice::WriteOnly | QIODevice::Append)) {
+    Error = "Could not open " + File.fileName();
+    return false;
+  }
+  Failed = false;
+  return true;
+}
+
+void Checkpoint::append(int unit, const QByteArray &record) {
+  // Written to disk by the next flush()
+  qint32 head[2] = {unit, record.size()};
+  write(reinterpret_cast<const char *>(head), sizeof(head));
+  write(record.constData(), record.size());
+}
+
+bool Checkpoint::flush() {
+  if (!File.flush() || Failed) {
+    Error = "Could not write " + File.fileName();
+    Failed = false;
+    return false;
+  }
+  return true;
+}
+
+bool Checkpoint::remove() {
+  File.close();
+  return File.remove();
+}
+
+quint64 Checkpoint::hash(const char *data, qint64 size, quint64 h) {
+  // 64 bit FNV-1a, pass the result as h to continue over further data
+  for (qint64 i=0; i < size; i++) {
+    h ^= static_cast<unsigned char>(data[i]);
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
@@ -0,0 +1,146 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#include "DataFile.h"
+#include <QByteArray>
+#include <QFileInfo>
+#include <iostream>
+
+using std::cout;
+using std::endl;
+
+static bool haveProgram(const char *name) {
+  // Check whether an executable can be found in PATH
+  QString cmd = QString("command -v %1 > /dev/null 2>&1").arg(name);
+  return system(cmd.toUtf8().data()) == 0;
+}
+
+static QString shellQuote(QString s) {
+  s.replace("'", "'\\''");
+  return "'" + s + "'";
+}
+
+DataFile::DataFile(QString name) {
+  FileName = name;
+  pipe = NULL;
+  if (name.endsWith(".gz")) {
+    Compression = "gzip";
+  } else if (name.endsWith(".zst")) {
+    Compression = "zstd";
+  } else {
+    Compression = "none";
+  }
+}
+
+DataFile::~DataFile() {
+  close();
+}
+
+QString DataFile::command(QIODevice::OpenMode mode) {
+  /**
+  Returns the shell command that (de)compresses the stream. Decompressors write
+  to stdout, compressors read from stdin and write into FileName. Returns an
+  empty string if no suitable program is installed.
+  **/
+  QString path = shellQuote(FileName);
+  bool write = mode & QIODevice::WriteOnly;
+  if (Compression == "gzip") {
+    if (haveProgram("pigz"))
+      return write ? "pigz -c > " + path : "pigz -dc " + path;
+    if (!haveProgram("gzip"))
+      return QString();
+    if (write)
+      cout << PRINT_WARNING "pigz not found, compressing with single-threaded "
+              "gzip.\n";
+    return write ? "gzip -c > " + path : "gzip -dc " + path;
+  }
+  if (!haveProgram("zstd"))
+    return QString();
+  return write ? "zstd -q -T0 -c > " + path : "zstd -q -dc " + path;
+}
+
+bool DataFile::open(QIODevice::OpenMode mode) {
+  if (Compression == "none") {
+    file.setFileName(FileName);
+    return file.open(mode);
+  }
+  if (!(mode & QIODevice::WriteOnly) && !QFile::exists(FileName))
+    return false;
+  if (mode & QIODevice::WriteOnly) {
+    // The shell redirection fails only after popen() has returned, and the
+    // first write would then end the program with SIGPIPE
+    QFileInfo out(FileName), dir(out.absolutePath());
+    if (!dir.isDir() || !dir.isWritable() ||
+        (out.exists() && !out.isWritable()))
+      return false;
+  }
+  QString cmd = command(mode);
+  if (cmd.isEmpty()) {
+    cout << PRINT_ERROR "Cannot process " << FileName.toUtf8().data()
+         << ", " << Compression.toUtf8().data() << " is not installed.\n";
+    return false;
+  }
+  pipe = popen(cmd.toUtf8().data(),
+               (mode & QIODevice::WriteOnly) ? "w" : "r");
+  if (pipe == NULL)
+    return false;
+  // The text flag is not needed on pipes and Unix only
+  return file.open(pipe, mode & ~QIODevice::Text);
+}
+
+bool DataFile::close() {
+  /**
+  Closes the file. For compressed files this waits until the (de)compressor has
+  finished and returns false if it reported an error.
+  **/
+  file.close();
+  if (pipe != NULL) {
+    int status = pclose(pipe);
+    pipe = NULL;
+    if (status != 0) {
+      cout << PRINT_ERROR << Compression.toUtf8().data() << " failed on "
+           << FileName.toUtf8().data() << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+int DataFile::countRows(QString name) {
+  /**
+  Returns the number of data lines of a file, i.e. lines that are neither empty
+  nor comments, or 0 if it cannot be read. Readers of scattered data reserve
+  memory for all points with it before they parse the file.
+  **/
+  DataFile in(name);
+  if (!in.open(QIODevice::ReadOnly))
+    return 0;
+  int n = 0;
+  bool lineStart = true;
+  QByteArray buf(1 << 20, 0);
+  qint64 len;
+  while ((len = in.device()->read(buf.data(), buf.size())) > 0) {
+    const char *c = buf.constData();
+    for (qint64 k=0; k < len; k++) {
+      if (lineStart && c[k] != '#' && c[k] != '\n' && c[k] != '\r')
+        n++;
+      lineStart = (c[k] == '\n');
+    }
+  }
+  in.close();
+  return n;
+}
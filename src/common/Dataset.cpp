@@ -0,0 +1,137 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#include "Dataset.h"
+#include <algorithm>
+
+struct MortonKey {
+  quint64 key;
+  int idx;
+  bool operator<(const MortonKey &o) const {return key < o.key;}
+};
+
+static quint64 spreadBits(quint64 v) {
+  // Inserts two zero bits after each of the lowest 21 bits of v
+  v &= 0x1fffff;
+  v = (v | v << 32) & 0x1f00000000ffffULL;
+  v = (v | v << 16) & 0x1f0000ff0000ffULL;
+  v = (v | v << 8) & 0x100f00f00f00f00fULL;
+  v = (v | v << 4) & 0x10c30c30c30c30c3ULL;
+  v = (v | v << 2) & 0x1249249249249249ULL;
+  return v;
+}
+
+Dataset::Dataset()
+  : Nodes(&Memory), Iter(&Memory), Stat(&Memory), Sequence(&Memory) {
+  for (int c=0; c < nColumns; c++)
+    Cols[c] = ArenaArray<double>(&Memory);
+}
+
+void Dataset::setGrid(int nx, int ny, int nz) {
+  /**
+  Declares the points to come as a regular grid of nx x ny x nz nodes and
+  reserves memory for them. Must be called before the first point is added.
+  **/
+  Nodes.setSize(nx, ny, nz);
+  reserve(nx*ny*nz);
+}
+
+void Dataset::reserve(int n) {
+  /**
+  Reserves memory for n points. Arrays grown by append() leave their old
+  storage unused in the arena, so readers reserve before the first point.
+  **/
+  Nodes.reserve(n);
+  for (int c=0; c < nColumns; c++)
+    Cols[c].reserve(n);
+  Iter.reserve(n);
+  Stat.reserve(n);
+}
+
+void Dataset::append(double x, double y, double z, Column c, double val) {
+  Nodes.append(x, y, z);
+  Cols[c].append(val);
+}
+
+void Dataset::allocate() {
+  /**
+  Sizes every column to the number of points. Columns that were not read are
+  set to NaN, iteration counts to 0 and status to Ok.
+  **/
+  int n = size();
+  for (int c=0; c < nColumns; c++) {
+    if (Cols[c].size() != n)
+      Cols[c].fill(NAN, n);
+  }
+  Iter.fill(0, n);
+  Stat.fill(Ok, n);
+}
+
+void Dataset::allocateExtra(int n) {
+  // Provides n additional result columns filled with NaN
+  Extra.resize(n);
+  for (int k=0; k < n; k++) {
+    Extra[k] = ArenaArray<double>(&Memory);
+    Extra[k].fill(NAN, size());
+  }
+}
+
+int Dataset::count(Status s) const {
+  int n = 0;
+  for (int i=0; i < Stat.size(); i++)
+    n += (Stat[i] == s);
+  return n;
+}
+
+const int *Dataset::order(Traversal t) {
+  /**
+  Returns the indices of all points in the order they should be processed.
+  Morton order sorts the points along a Z-order curve through the bounding
+  box, so that consecutive points are close in space.
+  **/
+  int n = size();
+  Sequence.resize(n);
+  for (int i=0; i < n; i++)
+    Sequence[i] = i;
+  if (t == FileOrder || n == 0)
+    return Sequence.constData();
+
+  double lo[3], scale[3];
+  for (int a=0; a < 3; a++) {
+    double hi = -1.7E308;
+    lo[a] = 1.7E308;
+    for (int i=0; i < n; i++) {
+      double c = (a == 0) ? x(i) : (a == 1) ? y(i) : z(i);
+      lo[a] = std::min(lo[a], c);
+      hi = std::max(hi, c);
+    }
+    scale[a] = (hi > lo[a]) ? 2097151.0/(hi - lo[a]) : 0.0;  // 21 bits
+  }
+  // Temporary, the arena would keep the keys until the dataset is deleted
+  QVector<MortonKey> keys(n);
+  for (int i=0; i < n; i++) {
+    quint64 ix = static_cast<quint64>((x(i) - lo[0])*scale[0]);
+    quint64 iy = static_cast<quint64>((y(i) - lo[1])*scale[1]);
+    quint64 iz = static_cast<quint64>((z(i) - lo[2])*scale[2]);
+    keys[i].key = spreadBits(ix) | spreadBits(iy) << 1 | spreadBits(iz) << 2;
+    keys[i].idx = i;
+  }
+  std::stable_sort(keys.begin(), keys.end());
+  for (int i=0; i < n; i++)
+    Sequence[i] = keys[i].idx;
+  return Sequence.constData();
+}
@@ -15,6 +15,7 @@
 *      You should have received a copy of the GNU General Public License       *
 *        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
 *******************************************************************************/
+#include <algorithm>
 #include "ERMs.h"
 
 using std::cout;
@@ -78,45 +79,58 @@ bool EarthReferenceModel::INIT_PREM() {
   return true;
 }
 
-double EarthReferenceModel::pressure(double z) {
+void EarthReferenceModel::integrate() {
+  /**
+  Sums up the pressure at the top of every layer, so that pressure() only
+  integrates the layer containing the requested depth.
+  **/
+  Bottom.clear();
+  Top.clear();
+  Top.append(0.);
+  for (int i=0; i+1 < ERMz.size(); i++) {
+    double z1 = ERMz.at(i)*1000;
+    double z2 = ERMz.at(i+1)*1000;
+    double Rho1 = ERMrho.at(i)*1000;
+    double Rho2 = ERMrho.at(i+1)*1000;
+    Bottom.append(z2);
+    Top.append(Top.last() + (z2 - z1)*(Rho1 + (Rho2 - Rho1)/2)*c_g);
+  }
+}
+
+double EarthReferenceModel::pressure(double z) const {
   /**
   Performs linear 1D pressure calculation with the given ERM
   Input: z - Depth in m a.s.l.
   Returns: Pcalc - Pressure at z in Pa
   **/
-  int i = 0;
-  double Pcalc, z_abs, z1, z2, Rho1, Rho2, dz;
-  bool DepthCalculated = false;
-  Pcalc = 0.;
-  z_abs = fabs(z);
-  while (!DepthCalculated) {
-    z1 = ERMz[i]*1000;
-    z2 = ERMz[i+1]*1000;
-    Rho1 = ERMrho[i]*1000;
-    Rho2 = ERMrho[i+1]*1000;
-    if ( z_abs < z2 ) {
-      Rho2 = Rho1 + (z_abs - z1)/(z2 - z1)*(Rho2 - Rho1);
-      dz = z_abs - z1;
-      DepthCalculated = true;
-    } else {
-      dz = z2 - z1;
-    }
-    Pcalc += dz*(Rho1 + (Rho2 - Rho1)/2)*c_g;
-    i += 1;
-  }
-  return Pcalc;
+  double z_abs = fabs(z);
+  // First layer with its bottom below z, the deepest layer is extrapolated
+  int i = std::upper_bound(Bottom.constBegin(), Bottom.constEnd(), z_abs)
+          - Bottom.constBegin();
+  if (i == Bottom.size())
+    i--;
+  double z1 = ERMz.at(i)*1000;
+  double z2 = ERMz.at(i+1)*1000;
+  double Rho1 = ERMrho.at(i)*1000;
+  double Rho2 = ERMrho.at(i+1)*1000;
+  Rho2 = Rho1 + (z_abs - z1)/(z2 - z1)*(Rho2 - Rho1);
+  return Top.at(i) + (z_abs - z1)*(Rho1 + (Rho2 - Rho1)/2)*c_g;
 }
 
 bool EarthReferenceModel::set(QString type) {
-  // Define a reference model
+  // Define a reference model, replacing a previously set one
+  if (type != "AK135" && type != "PREM") {
+    std::cout << "Unknown reference model " << type.toUtf8().data() << endl;
+    return false;
+  }
+  ERMz.clear();
+  ERMrho.clear();
   if (type == "AK135") {
     INIT_AK135();
-  } else if (type == "PREM") {
-    INIT_PREM();
   } else {
-    std::cout << "Unknown reference model " << type.toUtf8().data() << endl;
-    return false;
+    INIT_PREM();
   }
+  integrate();
   return true;
 }
 
@@ -0,0 +1,121 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#include "GridGeometry.h"
+
+static bool same(double a, double b) {
+  // Coordinates are parsed from text, allow for rounding only
+  return fabs(a - b) <= 1E-9*(1.0 + fabs(a) + fabs(b));
+}
+
+GridGeometry::GridGeometry(Arena *pool) : X(pool), Y(pool), Z(pool) {
+  setSize(0, 0, 0);
+}
+
+void GridGeometry::setSize(int nx, int ny, int nz) {
+  /**
+  Defines the number of grid nodes along x, y and z and removes all nodes. If
+  any size is 0 the coordinates are stored explicitly.
+  **/
+  N[0] = nx;
+  N[1] = ny;
+  N[2] = nz;
+  nOrder = 0;
+  Block = 1;
+  Count = 0;
+  Regular = (nx > 0 && ny > 0 && nz > 0);
+  for (int a=0; a < 3; a++)
+    Axis[a].fill(NAN, Regular ? N[a] : 0);
+  X.clear();
+  Y.clear();
+  Z.clear();
+}
+
+void GridGeometry::reserve(int n) {
+  // Only explicit coordinates need memory per node
+  if (Regular)
+    return;
+  X.reserve(n);
+  Y.reserve(n);
+  Z.reserve(n);
+}
+
+bool GridGeometry::fits(int n, const double c[3]) {
+  /**
+  Checks whether node n with the coordinates c is a node of the grid and
+  stores its coordinates along the axes. The first node of every block, i.e.
+  when the axes known so far are exhausted, determines the next axis.
+  **/
+  if (static_cast<double>(n) >= static_cast<double>(N[0])*N[1]*N[2])
+    return false;
+  if (n > 0 && n == Block && nOrder < 3) {
+    int next = -1;
+    for (int a=0; a < 3; a++) {
+      bool ordered = false;
+      for (int o=0; o < nOrder; o++)
+        ordered = ordered || Order[o] == a;
+      if (ordered || N[a] < 2 || same(c[a], Axis[a][0]))
+        continue;
+      if (next >= 0)
+        return false;
+      next = a;
+    }
+    if (next < 0)
+      return false;
+    Order[nOrder++] = next;
+    Block *= N[next];
+  }
+  for (int a=0; a < 3; a++) {
+    double &ref = Axis[a][index(n, a)];
+    if (isnan(ref))
+      ref = c[a];
+    else if (!same(ref, c[a]))
+      return false;
+  }
+  return true;
+}
+
+void GridGeometry::makeExplicit() {
+  // The grid size is still the best estimate for the number of nodes
+  int n = N[0]*N[1]*N[2];
+  X.reserve(n);
+  Y.reserve(n);
+  Z.reserve(n);
+  X.resize(Count);
+  Y.resize(Count);
+  Z.resize(Count);
+  for (int n=0; n < Count; n++) {
+    X[n] = x(n);
+    Y[n] = y(n);
+    Z[n] = z(n);
+  }
+  Regular = false;
+  for (int a=0; a < 3; a++)
+    Axis[a].clear();
+}
+
+void GridGeometry::append(double x, double y, double z) {
+  double c[3] = {x, y, z};
+  if (Regular && !fits(Count, c))
+    makeExplicit();
+  if (!Regular) {
+    X.append(x);
+    Y.append(y);
+    Z.append(z);
+  }
+  Count++;
+}
@@ -0,0 +1,32 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#include "MapIndex.h"
+
+void MapIndex::build(const QVector<Point3D> &map) {
+  Entry.clear();
+  for (int i=map.size()-1; i >= 0; i--)
+    Entry[map[i].x()].insert(map[i].y(), i);
+}
+
+int MapIndex::find(double x, double y) const {
+  // Returns -1 if the map has no entry at (x, y)
+  QMap<double, QMap<double, int> >::const_iterator col = Entry.find(x);
+  if (col == Entry.end())
+    return -1;
+  return col.value().value(y, -1);
+}
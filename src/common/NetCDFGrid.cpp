@@ -0,0 +1,377 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#include "NetCDFGrid.h"
+#include <algorithm>
+#include <string.h>
+#ifdef USE_NETCDF
+#include <netcdf.h>
+#endif
+
+NetCDFGrid::NetCDFGrid() {
+  for (int i=0; i < 6; i++)
+    slab[i] = -1;
+}
+
+void NetCDFGrid::setSlab(int x0, int x1, int y0, int y1, int z0, int z1) {
+  slab[0] = x0;
+  slab[1] = x1;
+  slab[2] = y0;
+  slab[3] = y1;
+  slab[4] = z0;
+  slab[5] = z1;
+}
+
+int NetCDFGrid::findAxis(const QVector<double> &axis, double val) {
+  // Returns the index of val in axis, or -1 if it is not a node of the axis
+  int n = axis.size();
+  double tol = 1E-6*std::max(1.0, fabs(axis[n-1] - axis[0]));
+  int i = std::lower_bound(axis.begin(), axis.end(), val - tol) - axis.begin();
+  if (i < n && fabs(axis[i] - val) <= tol)
+    return i;
+  return -1;
+}
+
+#ifdef USE_NETCDF
+static QVector<double> uniqueAxis(QVector<double> vals) {
+  // Sorted coordinate values, merging values closer than a relative tolerance
+  QVector<double> axis;
+  std::sort(vals.begin(), vals.end());
+  if (vals.isEmpty())
+    return axis;
+  double tol = 1E-6*std::max(1.0, fabs(vals.last() - vals.first()));
+  axis.append(vals[0]);
+  for (int i=1; i < vals.size(); i++) {
+    if (vals[i] - axis.last() > tol)
+      axis.append(vals[i]);
+  }
+  return axis;
+}
+
+static QString attText(int ncid, int varid, const char *att) {
+  size_t len;
+  if (nc_inq_attlen(ncid, varid, att, &len) != NC_NOERR)
+    return QString();
+  QByteArray buf(static_cast<int>(len), '\0');
+  nc_get_att_text(ncid, varid, att, buf.data());
+  return QString(buf).trimmed();
+}
+
+static int axisRole(int ncid, const char *dimname, int fallback) {
+  /**
+  Returns 0 for x, 1 for y and 2 for z, based on the CF 'axis' attribute of
+  the coordinate variable or on the dimension name.
+  **/
+  int varid;
+  if (nc_inq_varid(ncid, dimname, &varid) == NC_NOERR) {
+    QString axis = attText(ncid, varid, "axis").toUpper();
+    if (axis == "X") return 0;
+    if (axis == "Y") return 1;
+    if (axis == "Z") return 2;
+  }
+  QString name = QString(dimname).toLower();
+  if (name == "x" || name == "lon" || name == "longitude" || name == "easting")
+    return 0;
+  if (name == "y" || name == "lat" || name == "latitude" || name == "northing")
+    return 1;
+  if (name == "z" || name == "depth" || name == "height" || name == "altitude"
+      || name == "level")
+    return 2;
+  return fallback;
+}
+
+static bool check(int status, QString &Error) {
+  if (status != NC_NOERR) {
+    Error = nc_strerror(status);
+    return false;
+  }
+  return true;
+}
+#endif
+
+bool NetCDFGrid::read(QString FileName, QString VarName) {
+  /**
+  Reads the 3D variable VarName, or the first 3D variable in the file if
+  VarName is empty. The dimensions may be stored in any order. Coordinates with
+  the attribute positive="down" are converted to z positive upwards. Missing
+  values are set to NaN.
+  **/
+#ifdef USE_NETCDF
+  int ncid, varid, ndims, nvars;
+  int dimids[NC_MAX_VAR_DIMS];
+  int role[3];
+  size_t len[3], start[3], count[3];
+  QVector<double> axis[3];
+
+  if (!check(nc_open(FileName.toUtf8().data(), NC_NOWRITE, &ncid), Error))
+    return false;
+
+  if (VarName.isEmpty()) {
+    varid = -1;
+    nc_inq_nvars(ncid, &nvars);
+    for (int v=0; v < nvars && varid < 0; v++) {
+      nc_inq_varndims(ncid, v, &ndims);
+      if (ndims == 3)
+        varid = v;
+    }
+    if (varid < 0) {
+      Error = "No 3D variable in " + FileName;
+      nc_close(ncid);
+      return false;
+    }
+  } else if (!check(nc_inq_varid(ncid, VarName.toUtf8().data(), &varid),
+                    Error)) {
+    nc_close(ncid);
+    return false;
+  }
+  nc_inq_varndims(ncid, varid, &ndims);
+  if (ndims != 3) {
+    Error = QString("Variable has %1 dimensions instead of 3").arg(ndims);
+    nc_close(ncid);
+    return false;
+  }
+  nc_inq_vardimid(ncid, varid, dimids);
+
+  // Coordinate axes in the order of the file dimensions
+  bool used[3] = {false, false, false};
+  for (int d=0; d < 3; d++) {
+    char name[NC_MAX_NAME + 1];
+    int cvar;
+    nc_inq_dim(ncid, dimids[d], name, &len[d]);
+    role[d] = axisRole(ncid, name, 2 - d);  // CF recommends z, y, x
+    if (used[role[d]]) {
+      Error = QString("Cannot identify axis of dimension %1").arg(name);
+      nc_close(ncid);
+      return false;
+    }
+    used[role[d]] = true;
+    axis[d].resize(static_cast<int>(len[d]));
+    if (nc_inq_varid(ncid, name, &cvar) == NC_NOERR) {
+      nc_get_var_double(ncid, cvar, axis[d].data());
+      if (attText(ncid, cvar, "positive").toLower() == "down") {
+        for (int i=0; i < axis[d].size(); i++)
+          axis[d][i] = -axis[d][i];
+      }
+    } else {
+      for (int i=0; i < axis[d].size(); i++)
+        axis[d][i] = i;
+    }
+  }
+
+  // Hyperslab
+  for (int d=0; d < 3; d++) {
+    int lo = slab[2*role[d]];
+    int hi = slab[2*role[d] + 1];
+    if (lo < 0) lo = 0;
+    if (hi < 0) hi = static_cast<int>(len[d]) - 1;
+    if (lo > hi || hi >= static_cast<int>(len[d])) {
+      Error = QString("Hyperslab %1 to %2 exceeds dimension length %3")
+              .arg(lo).arg(hi).arg(static_cast<int>(len[d]));
+      nc_close(ncid);
+      return false;
+    }
+    start[d] = lo;
+    count[d] = hi - lo + 1;
+    QVector<double> sub;
+    for (int i=lo; i <= hi; i++)
+      sub.append(axis[d][i]);
+    if (role[d] == 0)
+      X = sub;
+    else if (role[d] == 1)
+      Y = sub;
+    else
+      Z = sub;
+  }
+
+  QVector<double> buf(static_cast<int>(count[0]*count[1]*count[2]));
+  if (!check(nc_get_vara_double(ncid, varid, start, count, buf.data()),
+             Error)) {
+    nc_close(ncid);
+    return false;
+  }
+
+  // Packing and missing values
+  double fill = NAN, missing = NAN, scale = 1, offset = 0;
+  nc_type type;
+  if (nc_get_att_double(ncid, varid, "_FillValue", &fill) != NC_NOERR &&
+      nc_inq_vartype(ncid, varid, &type) == NC_NOERR) {
+    // Without the attribute unwritten values hold the default fill value
+    if (type == NC_FLOAT)
+      fill = NC_FILL_FLOAT;
+    else if (type == NC_INT)
+      fill = NC_FILL_INT;
+    else if (type == NC_SHORT)
+      fill = NC_FILL_SHORT;
+    else if (type == NC_DOUBLE)
+      fill = NC_FILL_DOUBLE;
+  }
+  nc_get_att_double(ncid, varid, "missing_value", &missing);
+  nc_get_att_double(ncid, varid, "scale_factor", &scale);
+  nc_get_att_double(ncid, varid, "add_offset", &offset);
+  nc_close(ncid);
+
+  // Reorder to x fastest
+  int nx = X.size();
+  int ny = Y.size();
+  int ijk[3];
+  int n = 0;
+  Vals.resize(buf.size());
+  for (int a=0; a < static_cast<int>(count[0]); a++) {
+    ijk[role[0]] = a;
+    for (int b=0; b < static_cast<int>(count[1]); b++) {
+      ijk[role[1]] = b;
+      for (int c=0; c < static_cast<int>(count[2]); c++) {
+        ijk[role[2]] = c;
+        double v = buf[n++];
+        if (v == fill || v == missing)
+          v = NAN;
+        else
+          v = v*scale + offset;
+        Vals[(ijk[2]*ny + ijk[1])*nx + ijk[0]] = v;
+      }
+    }
+  }
+  return true;
+#else
+  Q_UNUSED(FileName);
+  Q_UNUSED(VarName);
+  Error = "VeloDT was built without NetCDF support (qmake CONFIG+=netcdf)";
+  return false;
+#endif
+}
+
+bool NetCDFGrid::write(QString FileName, const QVector<double> &x,
+                       const QVector<double> &y, const QVector<double> &z,
+                       const QList<NetCDFVariable> &vars, QString comment) {
+  /**
+  Writes point data that lie on a rectilinear grid as a CF volume with the
+  dimensions (z, y, x). The grid axes are derived from the point coordinates,
+  grid nodes without a point are set to NaN.
+  **/
+#ifdef USE_NETCDF
+  int ncid, dimids[3], coordids[3], status;
+  int npoints = x.size();
+  QVector<int> idx(npoints);
+  QVector<int> varids;
+
+  X = uniqueAxis(x);
+  Y = uniqueAxis(y);
+  Z = uniqueAxis(z);
+  if (npoints == 0 || static_cast<double>(nX())*nY()*nZ() > 64.0*npoints) {
+    Error = "Points do not form a regular grid";
+    return false;
+  }
+  for (int p=0; p < npoints; p++) {
+    int i = findAxis(X, x[p]);
+    int j = findAxis(Y, y[p]);
+    int k = findAxis(Z, z[p]);
+    idx[p] = (k*nY() + j)*nX() + i;
+  }
+
+  status = nc_create(FileName.toUtf8().data(), NC_CLOBBER | NC_NETCDF4, &ncid);
+  bool netcdf4 = (status == NC_NOERR);
+  if (!netcdf4)
+    status = nc_create(FileName.toUtf8().data(), NC_CLOBBER | NC_64BIT_OFFSET,
+                       &ncid);
+  if (!check(status, Error))
+    return false;
+
+  // Dimensions and coordinates
+  const char *names[3] = {"z", "y", "x"};
+  const char *axes[3] = {"Z", "Y", "X"};
+  const char *standard[3] = {"altitude", "projection_y_coordinate",
+                             "projection_x_coordinate"};
+  int len[3] = {nZ(), nY(), nX()};
+  bool ok = true;
+  for (int d=0; d < 3 && ok; d++) {
+    ok = check(nc_def_dim(ncid, names[d], len[d], &dimids[d]), Error) &&
+         check(nc_def_var(ncid, names[d], NC_DOUBLE, 1, &dimids[d],
+                          &coordids[d]), Error) &&
+         check(nc_put_att_text(ncid, coordids[d], "units", 1, "m"), Error) &&
+         check(nc_put_att_text(ncid, coordids[d], "axis", 1, axes[d]),
+               Error) &&
+         check(nc_put_att_text(ncid, coordids[d], "standard_name",
+                               strlen(standard[d]), standard[d]), Error);
+  }
+  if (!ok ||
+      !check(nc_put_att_text(ncid, coordids[0], "positive", 2, "up"), Error)) {
+    nc_close(ncid);
+    return false;
+  }
+
+  // Data variables
+  double fill = NAN;
+  for (int v=0; v < vars.size(); v++) {
+    int varid;
+    QByteArray name = vars[v].name.toUtf8();
+    QByteArray long_name = vars[v].long_name.toUtf8();
+    QByteArray units = vars[v].units.toUtf8();
+    ok = check(nc_def_var(ncid, name.data(), NC_DOUBLE, 3, dimids, &varid),
+               Error) &&
+         (!netcdf4 ||
+          check(nc_def_var_deflate(ncid, varid, 1, 1, 1), Error)) &&
+         check(nc_put_att_double(ncid, varid, "_FillValue", NC_DOUBLE, 1,
+                                 &fill), Error) &&
+         check(nc_put_att_text(ncid, varid, "long_name", long_name.size(),
+                               long_name.data()), Error) &&
+         check(nc_put_att_text(ncid, varid, "units", units.size(),
+                               units.data()), Error);
+    if (!ok) {
+      nc_close(ncid);
+      return false;
+    }
+    varids.append(varid);
+  }
+
+  QByteArray comm = comment.toUtf8();
+  ok = check(nc_put_att_text(ncid, NC_GLOBAL, "Conventions", 6, "CF-1.7"),
+             Error) &&
+       check(nc_put_att_text(ncid, NC_GLOBAL, "source", 6, "VeloDT"),
+             Error) &&
+       check(nc_put_att_text(ncid, NC_GLOBAL, "comment", comm.size(),
+                             comm.data()), Error) &&
+       check(nc_enddef(ncid), Error) &&
+       check(nc_put_var_double(ncid, coordids[0], Z.data()), Error) &&
+       check(nc_put_var_double(ncid, coordids[1], Y.data()), Error) &&
+       check(nc_put_var_double(ncid, coordids[2], X.data()), Error);
+  if (!ok) {
+    nc_close(ncid);
+    return false;
+  }
+
+  QVector<double> buf(nX()*nY()*nZ());
+  for (int v=0; v < vars.size(); v++) {
+    buf.fill(NAN);
+    for (int p=0; p < npoints; p++)
+      buf[idx[p]] = vars[v].vals[p];
+    if (!check(nc_put_var_double(ncid, varids[v], buf.data()), Error)) {
+      nc_close(ncid);
+      return false;
+    }
+  }
+  return check(nc_close(ncid), Error);
+#else
+  Q_UNUSED(FileName);
+  Q_UNUSED(x);
+  Q_UNUSED(y);
+  Q_UNUSED(z);
+  Q_UNUSED(vars);
+  Q_UNUSED(comment);
+  Error = "VeloDT was built without NetCDF support (qmake CONFIG+=netcdf)";
+  return false;
+#endif
+}
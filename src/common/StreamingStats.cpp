@@ -0,0 +1,106 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#include "StreamingStats.h"
+#include <algorithm>
+
+StreamingStats::StreamingStats(int nodes, const QList<double> &quantiles) {
+  nQ = quantiles.size();
+  Prob = quantiles;
+  Count.fill(0, nodes);
+  Mean.fill(0, nodes);
+  M2.fill(0, nodes);
+  Height.fill(0, nodes*nQ*5);
+  Pos.fill(0, nodes*nQ*5);
+}
+
+void StreamingStats::add(int i, double x) {
+  int n = ++Count[i];
+  double delta = x - Mean[i];
+  Mean[i] += delta/n;
+  M2[i] += delta*(x - Mean[i]);
+  for (int q=0; q < nQ; q++)
+    addMarkers((i*nQ + q)*5, Prob[q], n, x);
+}
+
+void StreamingStats::addMarkers(int m, double p, int n, double x) {
+  /**
+  P-square update of the markers starting at m with the n-th sample x. The
+  first five samples are stored, sorted and become the initial markers.
+  **/
+  double *h = Height.data() + m;
+  int *pos = Pos.data() + m;
+  if (n <= 5) {
+    h[n-1] = x;
+    if (n == 5) {
+      std::sort(h, h + 5);
+      for (int j=0; j < 5; j++)
+        pos[j] = j + 1;
+    }
+    return;
+  }
+
+  // Cell of x, the extreme markers follow minimum and maximum
+  int k;
+  if (x < h[0]) {
+    h[0] = x;
+    k = 0;
+  } else if (x >= h[4]) {
+    h[4] = x;
+    k = 3;
+  } else {
+    k = 0;
+    while (x >= h[k+1])
+      k++;
+  }
+  for (int j=k+1; j < 5; j++)
+    pos[j]++;
+
+  // Move the inner markers towards their desired positions
+  const double dn[5] = {0, p/2, p, (1 + p)/2, 1};
+  for (int j=1; j < 4; j++) {
+    double d = 1 + (n - 1)*dn[j] - pos[j];
+    if ((d >= 1 && pos[j+1] - pos[j] > 1)
+        || (d <= -1 && pos[j-1] - pos[j] < -1)) {
+      int s = (d > 0) ? 1 : -1;
+      // Piecewise parabolic prediction, linear if it leaves the neighbours
+      double hp = h[j] + static_cast<double>(s)/(pos[j+1] - pos[j-1])
+                  *((pos[j] - pos[j-1] + s)*(h[j+1] - h[j])/(pos[j+1] - pos[j])
+                    + (pos[j+1] - pos[j] - s)*(h[j] - h[j-1])
+                      /(pos[j] - pos[j-1]));
+      if (h[j-1] < hp && hp < h[j+1])
+        h[j] = hp;
+      else
+        h[j] = h[j] + s*(h[j+s] - h[j])/(pos[j+s] - pos[j]);
+      pos[j] += s;
+    }
+  }
+}
+
+double StreamingStats::quantile(int i, int q) const {
+  // NAN without samples
+  int n = Count[i];
+  const double *h = Height.constData() + (i*nQ + q)*5;
+  if (n == 0)
+    return NAN;
+  if (n >= 5)
+    return h[2];
+  QVector<double> s(n);
+  std::copy(h, h + n, s.begin());
+  std::sort(s.begin(), s.end());
+  return s[static_cast<int>(round(Prob[q]*(n - 1)))];
+}
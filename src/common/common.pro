@@ -2,8 +2,25 @@ INCLUDEPATH += ../../include/common
 WARNINGS += -Wall
 TEMPLATE = lib
 CONFIG += staticlib
-SOURCES += ERMS.cpp PointClasses.cpp
-HEADERS += ../../include/common/ERMS.h \
+SOURCES += ERMs.cpp DataFile.cpp NetCDFGrid.cpp \
+           GridGeometry.cpp Dataset.cpp Arena.cpp \
+           MapIndex.cpp Checkpoint.cpp StreamingStats.cpp
+HEADERS += ../../include/common/ERMs.h \
            ../../include/common/PointClasses.h \
            ../../include/common/ANSIICodes.h \
-           ../../include/common/PhysicalConstants.h
+           ../../include/common/PhysicalConstants.h \
+           ../../include/common/DataFile.h \
+           ../../include/common/NetCDFGrid.h \
+           ../../include/common/GridGeometry.h \
+           ../../include/common/Dataset.h \
+           ../../include/common/Arena.h \
+           ../../include/common/MapIndex.h \
+           ../../include/common/Checkpoint.h \
+           ../../include/common/StreamingStats.h \
+           ../../include/common/Dual.h \
+           ../../include/common/MineralDB.h
+
+# Optional NetCDF support: qmake CONFIG+=netcdf
+netcdf {
+  DEFINES += USE_NETCDF
+}
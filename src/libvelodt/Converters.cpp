@@ -0,0 +1,192 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#include "Converters.h"
+#include <cmath>
+
+namespace {
+
+const int Chunk = 1024;  // Points whose pressures are kept on the stack
+
+bool validComposition(const double comp[5]) {
+  // Same test as Rock::set_Comp() in V2RhoT
+  return comp[0] + comp[1] + comp[2] + comp[3] + comp[4] == 1.0;
+}
+
+bool positive(double val) {
+  // Thresholds of the iterations, which do not end for values <= 0
+  return std::isfinite(val) && val > 0;
+}
+
+}  // namespace
+
+const EarthReferenceModel *Converter::referenceModel(velodt_erm erm) {
+  // Shared by all converters and never modified after construction
+  static const EarthReferenceModel AK135("AK135");
+  static const EarthReferenceModel PREM("PREM");
+  switch (erm) {
+    case VELODT_AK135:
+      return &AK135;
+    case VELODT_PREM:
+      return &PREM;
+    default:
+      return 0;
+  }
+}
+
+const MineralSet *Converter::mineralSet(velodt_minerals minerals) {
+  switch (minerals) {
+    case VELODT_GOES:
+      return &MineralDB::Goes;
+    case VELODT_CAMMARANO:
+      return &MineralDB::Cammarano;
+    default:
+      return 0;
+  }
+}
+
+V2TConverter::V2TConverter(const v2t_config &cfg) {
+  /**
+  Same as V2T with one parameter set and the pressure of an Earth reference
+  model.
+  **/
+  ERM = referenceModel(cfg.erm);
+  if (ERM == 0 || !positive(cfg.threshold) || !std::isfinite(cfg.bV)
+      || !std::isfinite(cfg.m) || !std::isfinite(cfg.c)
+      || !std::isfinite(cfg.A) || !std::isfinite(cfg.E)
+      || !std::isfinite(cfg.Va))
+    Status = VELODT_INVALID_ARGUMENT;
+  Kernel.threshold = cfg.threshold;
+  if (cfg.newton)
+    Kernel.Solver = TemperatureSolver::Newton;
+  p.bV = cfg.bV;
+  p.m = cfg.m;
+  p.c = cfg.c;
+  p.A = cfg.A;
+  p.E = cfg.E;
+  p.Va = cfg.Va;
+}
+
+velodt_status V2TConverter::convert(size_t n, const double *z,
+                                    const double *in, double *out0,
+                                    double *) const {
+  // Points for which the root finder fails are set to NaN
+  if (Status != VELODT_OK)
+    return Status;
+  velodt_status result = VELODT_OK;
+  double P[Chunk];
+  int stat[Chunk];
+  for (size_t i0=0; i0 < n; i0 += Chunk) {
+    int m = static_cast<int>(qMin(static_cast<size_t>(Chunk), n - i0));
+    for (int k=0; k < m; k++)
+      P[k] = ERM->pressure(z[i0 + k]);
+    Kernel.convert(m, p, z + i0, in + i0, P, out0 + i0, stat);
+    for (int k=0; k < m; k++) {
+      if (stat[k] != Dataset::Ok) {
+        out0[i0 + k] = NAN;
+        result = VELODT_NOT_CONVERGED;
+      }
+    }
+  }
+  return result;
+}
+
+T2RhoConverter::T2RhoConverter(const t2rho_config &cfg) {
+  // Same as T2Rho, including the pressure taken 1 m below z
+  ERM = referenceModel(cfg.erm);
+  const MineralSet *DB = mineralSet(cfg.minerals);
+  if (ERM == 0 || DB == 0 || !std::isfinite(cfg.XFe))
+    Status = VELODT_INVALID_ARGUMENT;
+  else if (!validComposition(cfg.composition))
+    Status = VELODT_INVALID_COMPOSITION;
+  else
+    Kernel.prepare(*DB, cfg.composition, cfg.XFe, cfg.alphaT != 0);
+}
+
+velodt_status T2RhoConverter::convert(size_t n, const double *z,
+                                      const double *in, double *out0,
+                                      double *) const {
+  if (Status != VELODT_OK)
+    return Status;
+  double P[Chunk];
+  for (size_t i0=0; i0 < n; i0 += Chunk) {
+    int m = static_cast<int>(qMin(static_cast<size_t>(Chunk), n - i0));
+    for (int k=0; k < m; k++)
+      P[k] = ERM->pressure(z[i0 + k] + 1);
+    Kernel.densities(m, P, in + i0, out0 + i0);
+  }
+  return VELODT_OK;
+}
+
+V2RhoTConverter::V2RhoTConverter(const v2rhot_config &cfg) {
+  /**
+  Same as V2RhoT with the pressure of an Earth reference model and the
+  anelasticity of Sobolev et al. (1996).
+  **/
+  Model = 0;
+  T_start = cfg.T_start;
+  Fdamp = cfg.damping;
+  threshold = cfg.threshold;
+  ERM = referenceModel(cfg.erm);
+  const MineralSet *DB = mineralSet(cfg.minerals);
+  if (ERM == 0 || DB == 0 || (cfg.wave != 'S' && cfg.wave != 'P')
+      || !positive(cfg.threshold) || !positive(cfg.damping)
+      || cfg.damping > 1 || !positive(cfg.T_start)
+      || !std::isfinite(cfg.frequency) || !std::isfinite(cfg.XFe)) {
+    Status = VELODT_INVALID_ARGUMENT;
+    return;
+  }
+  if (!validComposition(cfg.composition)) {
+    Status = VELODT_INVALID_COMPOSITION;
+    return;
+  }
+  // Default frequencies as Rock::set_omega()
+  QString VelType(QChar(cfg.wave));
+  double f = cfg.frequency;
+  if (f <= 0)
+    f = (VelType == "S") ? 1 : 0.02;
+  Model = new RockModel(*DB, cfg.composition, cfg.XFe, cfg.alphaT != 0,
+                        Anelasticity::Sobolev, f, VelType);
+}
+
+V2RhoTConverter::~V2RhoTConverter() {
+  delete Model;
+}
+
+velodt_status V2RhoTConverter::convert(size_t n, const double *z,
+                                       const double *in, double *out0,
+                                       double *out1) const {
+  // Points that do not converge within 10000 steps are set to NaN
+  if (Status != VELODT_OK)
+    return Status;
+  velodt_status result = VELODT_OK;
+  for (size_t i=0; i < n; i++) {
+    double TK;
+    int steps;
+    RockProperties props;
+    if (Model->invert(in[i], ERM->pressure(z[i]), T_start, Fdamp, threshold,
+                      TK, steps, props)) {
+      out0[i] = TK - 273.15;
+      out1[i] = props.rho;
+    } else {
+      out0[i] = NAN;
+      out1[i] = NAN;
+      result = VELODT_NOT_CONVERGED;
+    }
+  }
+  return result;
+}
@@ -0,0 +1,104 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#include "libvelodt.h"
+#include "Converters.h"
+
+namespace {
+
+void defaultComposition(double comp[5]) {
+  const double c[5] = {0.67, 0.225, 0.045, 0.0, 0.06};
+  for (int i=0; i < 5; i++)
+    comp[i] = c[i];
+}
+
+}  // namespace
+
+void v2t_config_init(v2t_config *cfg) {
+  Calibration p = TemperatureSolver::defaults();
+  TemperatureSolver solver;
+  cfg->erm = VELODT_AK135;
+  cfg->bV = p.bV;
+  cfg->m = p.m;
+  cfg->c = p.c;
+  cfg->A = p.A;
+  cfg->E = p.E;
+  cfg->Va = p.Va;
+  cfg->threshold = solver.threshold;
+  cfg->newton = 0;
+}
+
+void t2rho_config_init(t2rho_config *cfg) {
+  cfg->erm = VELODT_AK135;
+  cfg->minerals = VELODT_GOES;
+  defaultComposition(cfg->composition);
+  cfg->XFe = 0.1;
+  cfg->alphaT = 0;
+}
+
+void v2rhot_config_init(v2rhot_config *cfg) {
+  cfg->erm = VELODT_AK135;
+  cfg->minerals = VELODT_CAMMARANO;
+  defaultComposition(cfg->composition);
+  cfg->XFe = 0.0;
+  cfg->alphaT = 0;
+  cfg->wave = 'S';
+  cfg->frequency = 0;
+  cfg->threshold = 0.1;
+  cfg->damping = 0.025;
+  cfg->T_start = 273.15;
+}
+
+velodt_status v2t_convert(const double *z, const double *Vs, size_t n,
+                          double *T, const v2t_config *cfg) {
+  if (cfg == 0 || (n > 0 && (z == 0 || Vs == 0 || T == 0)))
+    return VELODT_INVALID_ARGUMENT;
+  const V2TConverter Conversion(*cfg);
+  return Conversion.convert(n, z, Vs, T, 0);
+}
+
+velodt_status t2rho_convert(const double *z, const double *T, size_t n,
+                            double *rho, const t2rho_config *cfg) {
+  if (cfg == 0 || (n > 0 && (z == 0 || T == 0 || rho == 0)))
+    return VELODT_INVALID_ARGUMENT;
+  const T2RhoConverter Conversion(*cfg);
+  return Conversion.convert(n, z, T, rho, 0);
+}
+
+velodt_status v2rhot_convert(const double *z, const double *V, size_t n,
+                             double *T, double *rho,
+                             const v2rhot_config *cfg) {
+  if (cfg == 0 || (n > 0 && (z == 0 || V == 0 || T == 0 || rho == 0)))
+    return VELODT_INVALID_ARGUMENT;
+  const V2RhoTConverter Conversion(*cfg);
+  return Conversion.convert(n, z, V, T, rho);
+}
+
+const char *velodt_status_string(velodt_status status) {
+  switch (status) {
+    case VELODT_OK:
+      return "ok";
+    case VELODT_INVALID_ARGUMENT:
+      return "invalid argument";
+    case VELODT_INVALID_COMPOSITION:
+      return "composition sum must equal 1.0";
+    case VELODT_NOT_CONVERGED:
+      return "iteration did not converge";
+    default:
+      return "unknown status";
+  }
+}
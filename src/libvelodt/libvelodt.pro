@@ -0,0 +1,34 @@
+################################################################################
+#                     Copyright (C) 2020 by Christian Meeßen                   #
+#                                                                              #
+#                          This file is part of VeloDT.                        #
+#                                                                              #
+#         VeloDT is free software: you can redistribute it and/or modify       #
+#     it under the terms of the GNU General Public License as published by     #
+#           the Free Software Foundation version 3 of the License.             #
+#                                                                              #
+#        VeloDT is distributed in the hope that it will be useful, but         #
+#          WITHOUT ANY WARRANTY; without even the implied warranty of          #
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       #
+#                   General Public License for more details.                   #
+#                                                                              #
+#      You should have received a copy of the GNU General Public License       #
+#        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        #
+################################################################################
+TEMPLATE = lib
+DESTDIR = ../../lib
+TARGET = velodt
+# Shared by default, build a static library with 'qmake CONFIG+=staticlib'
+CONFIG += c++11
+
+INCLUDEPATH += ../../include/common ../../include/libvelodt \
+               ../../include/V2T ../../include/T2Rho ../../include/V2RhoT
+
+LIBS += -L../common -lcommon
+
+SOURCES += libvelodt.cpp Converters.cpp \
+           ../V2T/TemperatureSolver.cpp ../T2Rho/DensityKernel.cpp \
+           ../V2RhoT/RockModel.cpp ../V2RhoT/MineraldRhodT.cpp
+
+HEADERS += ../../include/libvelodt/libvelodt.h \
+           ../../include/libvelodt/Converters.h
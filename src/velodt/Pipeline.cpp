@@ -0,0 +1,171 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#include "Pipeline.h"
+
+using std::cout;
+using std::endl;
+
+void Pipeline::usage() {
+  cout << endl
+       << "usage: velodt pipeline Stages File_In File_Out [options]" << endl
+       << endl
+       << "Runs the conversion tools one after another in one process. The" << endl
+       << "results of a stage are passed to the next one in memory, only the" << endl
+       << "last stage writes File_Out." << endl
+       << endl
+       << "  Stages           Comma separated list of stages:" << endl
+       << "                     v2t        V2T alone" << endl
+       << "                     t2rho      T2Rho alone" << endl
+       << "                     v2rhot     V2RhoT alone" << endl
+       << "                     v2t,t2rho  Vs to temperature to density" << endl
+       << "  File_In          Input file of the first stage" << endl
+       << "  File_Out         Output file of the last stage" << endl
+       << endl
+       << "  The options are passed to every stage, see the usage of V2T," << endl
+       << "  T2Rho and V2RhoT. Options of both V2T and T2Rho, e.g. -ERM or" << endl
+       << "  -threads, apply to both stages." << endl
+       << endl
+       << "  Example:" << endl
+       << "  velodt pipeline v2t,t2rho Vs.dat Rho.dat -ERM PREM -scaleZ -1000" << endl
+       << endl
+       << "See 'velodt serve -h' for converting points sent over a socket." << endl
+       << endl;
+  exit(0);
+}
+
+bool Pipeline::setStages(QString chain) {
+  /**
+  Reads the comma separated list of stages. A stage that produces
+  temperatures can be followed by T2Rho, V2RhoT already gives densities.
+  **/
+  QStringList names = chain.toLower().split(",");
+  Stages.clear();
+  for (int i=0; i < names.size(); i++) {
+    if (names[i] == "v2t") {
+      Stages.append(StageV2T);
+    } else if (names[i] == "t2rho") {
+      Stages.append(StageT2Rho);
+    } else if (names[i] == "v2rhot") {
+      Stages.append(StageV2RhoT);
+    } else {
+      cout << PRINT_ERROR "Unknown stage " << names[i].toUtf8().data()
+           << endl;
+      return false;
+    }
+  }
+  for (int i=1; i < Stages.size(); i++) {
+    if (Stages[i] != StageT2Rho || Stages[i-1] != StageV2T) {
+      cout << PRINT_ERROR "Stage " << names[i].toUtf8().data()
+           << " can not follow " << names[i-1].toUtf8().data() << endl;
+      return false;
+    }
+  }
+  Chain = chain;
+  return true;
+}
+
+void Pipeline::readArgs(int &argc, char *argv[]) {
+  /**
+  Input convention
+  velodt pipeline [Stages] [FileIn] [FileOut] [[args]]
+  **/
+  QStringList arg;
+  for (int i=0; i < argc; i++)
+    arg << argv[i];
+
+  if (argc < 2 || arg[1] == "-h" || arg[1] == "-help") {
+    usage();
+  } else if (arg[1] != "pipeline") {
+    cout << PRINT_ERROR "Unknown command " << arg[1].toUtf8().data() << endl;
+    usage();
+  } else if (argc < 5) {
+    cout << endl << endl << PRINT_ERROR "Not enough arguments!\n\n";
+    usage();
+  } else if (!setStages(arg[2])) {
+    exit(1);
+  }
+}
+
+void Pipeline::run(int &argc, char *argv[]) {
+  /**
+  The stages see the command line from the list of stages on, i.e. the
+  input and output file are their first two arguments.
+  **/
+  int n = argc - 2;
+  char **args = argv + 2;
+  QElapsedTimer timer;
+  qint64 t_read, t_conv;
+
+  readArgs(argc, argv);
+  cout << "Pipeline: " << Chain.toUtf8().data() << endl;
+  if (Stages.first() == StageV2RhoT) {
+    V2RhoT VelRho;
+    VelRho.readArgs(n, args);
+    VelRho.Info();
+    timer.start();
+    VelRho.readFile(VelRho.FileIn(), "vox");
+    if (!VelRho.FileJoint().isEmpty())
+      VelRho.readJoint(VelRho.FileJoint());
+    t_read = timer.restart();
+    VelRho.Iterate();
+    t_conv = timer.restart();
+    for (int k=0; k < VelRho.jobs(); k++)
+      VelRho.saveFile(VelRho.FileOut(k), k);
+    VelRho.removeCheckpoint();
+  } else if (Stages.first() == StageT2Rho) {
+    T2Rho Density;
+    Density.readArgs(n, args);
+    Density.info();
+    timer.start();
+    Density.readFile();
+    t_read = timer.restart();
+    Density.calcDensity();
+    t_conv = timer.restart();
+    Density.writeFile();
+  } else {
+    V2T VelTemp;
+    T2Rho Density;
+    bool toRho = Stages.size() > 1;
+    VelTemp.readArgs(n, args);
+    VelTemp.Info();
+    if (toRho) {
+      Density.readArgs(n, args);
+      Density.info();
+    }
+    timer.start();
+    VelTemp.readFile(VelTemp.FileIn(), "vox");
+    if (VelTemp.UseCrust()) {
+      VelTemp.readFile(VelTemp.FileTCrust(), "crust");
+      VelTemp.readFile(VelTemp.FileZTopo(), "topo");
+    }
+    VelTemp.test_data();
+    t_read = timer.restart();
+    VelTemp.newton();
+    if (toRho) {
+      Density.setInput(VelTemp.dataset());
+      Density.calcDensity();
+    }
+    t_conv = timer.restart();
+    if (toRho)
+      Density.writeFile();
+    else
+      VelTemp.saveFile(VelTemp.FileOut());
+  }
+  cout << "Run time / s: reading " << t_read/1000.0 << ", conversion "
+       << t_conv/1000.0 << ", writing " << timer.elapsed()/1000.0 << endl;
+}
@@ -0,0 +1,403 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#include "Server.h"
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using std::cout;
+using std::endl;
+
+namespace {
+
+char SocketPath[sizeof(sockaddr_un::sun_path)];  // Removed when stopped
+
+void stop(int) {
+  // Only async-signal-safe calls
+  unlink(SocketPath);
+  _exit(0);
+}
+
+double value(const QVector<double> &params, int i, double def) {
+  return (i < params.size()) ? params[i] : def;
+}
+
+}  // namespace
+
+Server::Server() {
+  Socket = "/tmp/velodt.sock";
+  Threads = 0;
+  Listen = -1;
+}
+
+Server::~Server() {
+  QList<Converter *> all = Cache.values();
+  for (int i=0; i < all.size(); i++)
+    delete all[i];
+  if (Listen >= 0)
+    close(Listen);
+}
+
+void Server::usage() {
+  cout << endl
+       << "usage: velodt serve [options]" << endl
+       << endl
+       << "Converts points sent over a Unix domain socket until it is" << endl
+       << "interrupted. Connections are served at the same time, converters" << endl
+       << "are kept for later requests with the same settings." << endl
+       << endl
+       << "  -socket   path  /tmp/velodt.sock Path of the socket" << endl
+       << "  -threads  val                  0 Connections served at once," << endl
+       << "                                   0 = all cores" << endl
+       << endl
+       << "Each request is answered before the next one is read, values in"
+       << endl
+       << "host byte order:" << endl
+       << "  request   int32 op, int32 nParams, int64 n," << endl
+       << "            double params[nParams], double z[n], double in[n]"
+       << endl
+       << "  response  int32 status, int32 nOut, int64 n, double out[nOut][n]"
+       << endl
+       << endl
+       << "  op  in            out              params" << endl
+       << "   0  -             -                -  (ping)" << endl;
+  const char *io[3][2] = {{"Vs / km/s", "T / degC"},
+                          {"T / degC", "rho / kg/m3"},
+                          {"V / m/s", "T / degC, rho"}};
+  for (int op=OpV2T; op <= OpV2RhoT; op++) {
+    // Wrap the params after 40 characters
+    QStringList names = paramNames(op);
+    QString line = names[0];
+    printf("  %2d  %-12s  %-15s  ", op, io[op-1][0], io[op-1][1]);
+    for (int i=1; i < names.size(); i++) {
+      if (line.size() + names[i].size() >= 40) {
+        printf("%s\n%37s", line.toUtf8().data(), "");
+        line = names[i];
+      } else {
+        line += " " + names[i];
+      }
+    }
+    printf("%s\n", line.toUtf8().data());
+  }
+  cout << endl
+       << "  Depth z in m. Missing params keep the defaults of libvelodt," << endl
+       << "  erm: 0 AK135, 1 PREM; minerals: 0 Goes, 1 Cammarano;" << endl
+       << "  wave: 0 S, 1 P. status is 0 if all points were converted, see"
+       << endl
+       << "  libvelodt.h for the others. Example/velodt_client.py is a" << endl
+       << "  client for Python scripts." << endl
+       << endl;
+  exit(0);
+}
+
+void Server::argsError(QString val, bool ok) {
+  if (!ok) {
+    cout << PRINT_ERROR "Invalid value in " << val.toUtf8().data() << endl;
+    exit(1);
+  }
+}
+
+void Server::readArgs(int &argc, char *argv[]) {
+  /**
+  Input convention
+  velodt serve [[args]]
+  **/
+  QStringList arg;
+  bool ok;
+  for (int i=0; i < argc; i++)
+    arg << argv[i];
+
+  for (int i=2; i < argc; i++) {
+    if (arg[i] == "-h" || arg[i] == "-help") {
+      usage();
+    } else if (arg[i] == "-socket" && i+1 < argc) {
+      Socket = arg[i+1];
+      i++;
+    } else if (arg[i] == "-threads" && i+1 < argc) {
+      Threads = arg[i+1].toInt(&ok);
+      argsError(arg[i], ok && Threads >= 0);
+      i++;
+    } else {
+      cout << PRINT_ERROR "Unknown argument " << arg[i].toUtf8().data()
+           << endl;
+      exit(1);
+    }
+  }
+}
+
+int Server::threads() {
+  // Size of the pool
+#ifdef _OPENMP
+  return (Threads > 0) ? Threads : omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+QStringList Server::paramNames(int op) {
+  QStringList names;
+  if (op == OpV2T) {
+    names << "erm" << "bV" << "m" << "c" << "A" << "E" << "Va" << "threshold"
+          << "newton";
+  } else if (op == OpT2Rho || op == OpV2RhoT) {
+    names << "erm" << "minerals" << "Ol" << "Opx" << "Cpx" << "Sp" << "Gnt"
+          << "XFe" << "alphaT";
+    if (op == OpV2RhoT)
+      names << "wave" << "frequency" << "threshold" << "damping" << "T_start";
+  }
+  return names;
+}
+
+Converter *Server::build(int op, const QVector<double> &params) {
+  // Converter for op with params in the order of paramNames()
+  if (op == OpV2T) {
+    v2t_config cfg;
+    v2t_config_init(&cfg);
+    cfg.erm = static_cast<velodt_erm>(
+        static_cast<int>(value(params, 0, cfg.erm)));
+    cfg.bV = value(params, 1, cfg.bV);
+    cfg.m = value(params, 2, cfg.m);
+    cfg.c = value(params, 3, cfg.c);
+    cfg.A = value(params, 4, cfg.A);
+    cfg.E = value(params, 5, cfg.E);
+    cfg.Va = value(params, 6, cfg.Va);
+    cfg.threshold = value(params, 7, cfg.threshold);
+    cfg.newton = static_cast<int>(value(params, 8, cfg.newton));
+    return new V2TConverter(cfg);
+  } else if (op == OpT2Rho) {
+    t2rho_config cfg;
+    t2rho_config_init(&cfg);
+    cfg.erm = static_cast<velodt_erm>(
+        static_cast<int>(value(params, 0, cfg.erm)));
+    cfg.minerals = static_cast<velodt_minerals>(
+        static_cast<int>(value(params, 1, cfg.minerals)));
+    for (int i=0; i < 5; i++)
+      cfg.composition[i] = value(params, 2 + i, cfg.composition[i]);
+    cfg.XFe = value(params, 7, cfg.XFe);
+    cfg.alphaT = static_cast<int>(value(params, 8, cfg.alphaT));
+    return new T2RhoConverter(cfg);
+  } else {
+    v2rhot_config cfg;
+    v2rhot_config_init(&cfg);
+    cfg.erm = static_cast<velodt_erm>(
+        static_cast<int>(value(params, 0, cfg.erm)));
+    cfg.minerals = static_cast<velodt_minerals>(
+        static_cast<int>(value(params, 1, cfg.minerals)));
+    for (int i=0; i < 5; i++)
+      cfg.composition[i] = value(params, 2 + i, cfg.composition[i]);
+    cfg.XFe = value(params, 7, cfg.XFe);
+    cfg.alphaT = static_cast<int>(value(params, 8, cfg.alphaT));
+    int wave = static_cast<int>(value(params, 9, 0));
+    cfg.wave = (wave == 0) ? 'S' : ((wave == 1) ? 'P' : '?');
+    cfg.frequency = value(params, 10, cfg.frequency);
+    cfg.threshold = value(params, 11, cfg.threshold);
+    cfg.damping = value(params, 12, cfg.damping);
+    cfg.T_start = value(params, 13, cfg.T_start);
+    return new V2RhoTConverter(cfg);
+  }
+}
+
+const Converter *Server::converter(int op, const QVector<double> &params,
+                                   Converter *&own) {
+  /**
+  Converter from the cache, built and added if it is not there yet. Once
+  the cache is full, new converters are only used for one request and
+  returned in own, which the caller deletes.
+  **/
+  QByteArray key(1, static_cast<char>(op));
+  key.append(reinterpret_cast<const char *>(params.constData()),
+             params.size()*static_cast<int>(sizeof(double)));
+  const Converter *found;
+  own = 0;
+#ifdef _OPENMP
+  #pragma omp critical(ServerCache)
+#endif
+  found = Cache.value(key, 0);
+  if (found != 0)
+    return found;
+
+  // Built outside of the lock, another thread may add the same one meanwhile
+  Converter *made = build(op, params);
+  if (made->status() != VELODT_OK) {
+    // Invalid settings are answered with the status and not cached
+    own = made;
+    return made;
+  }
+#ifdef _OPENMP
+  #pragma omp critical(ServerCache)
+#endif
+  {
+    found = Cache.value(key, 0);
+    if (found == 0 && Cache.size() < MaxCache) {
+      Cache.insert(key, made);
+      found = made;
+      made = 0;
+    }
+  }
+  if (found == 0) {
+    own = made;
+    return made;
+  }
+  delete made;
+  return found;
+}
+
+bool Server::receiveAll(int fd, void *buf, size_t len) {
+  char *p = static_cast<char *>(buf);
+  while (len > 0) {
+    ssize_t got = recv(fd, p, len, 0);
+    if (got < 0 && errno == EINTR)
+      continue;
+    if (got <= 0)
+      return false;
+    p += got;
+    len -= got;
+  }
+  return true;
+}
+
+bool Server::sendAll(int fd, const void *buf, size_t len) {
+  const char *p = static_cast<const char *>(buf);
+  while (len > 0) {
+    ssize_t sent = ::send(fd, p, len, MSG_NOSIGNAL);
+    if (sent < 0 && errno == EINTR)
+      continue;
+    if (sent <= 0)
+      return false;
+    p += sent;
+    len -= sent;
+  }
+  return true;
+}
+
+bool Server::serve(int fd) {
+  /**
+  Answers the requests of one connection until the client closes it. A
+  request with an invalid header is answered with VELODT_INVALID_ARGUMENT
+  and the connection is closed, as the rest of it can not be parsed.
+  **/
+  QVector<double> params, in, out;
+  while (true) {
+    qint32 head[2];
+    qint64 n;
+    if (!receiveAll(fd, head, sizeof(head)))
+      return true;
+    if (!receiveAll(fd, &n, sizeof(n)))
+      return false;
+    int op = head[0];
+    int nParams = head[1];
+    qint32 reply[2] = {VELODT_OK, 0};
+    if (op < OpPing || op > OpV2RhoT || nParams < 0
+        || nParams > paramNames(op).size() || n < 0 || n > MaxPoints
+        || (op == OpPing && n > 0)) {
+      reply[0] = VELODT_INVALID_ARGUMENT;
+      n = 0;
+      sendAll(fd, reply, sizeof(reply));
+      sendAll(fd, &n, sizeof(n));
+      return false;
+    }
+    params.resize(nParams);
+    in.resize(2*static_cast<int>(n));
+    if (!receiveAll(fd, params.data(), nParams*sizeof(double))
+        || !receiveAll(fd, in.data(), 2*n*sizeof(double)))
+      return false;
+
+    if (op != OpPing) {
+      Converter *own;
+      const Converter *conv = converter(op, params, own);
+      if (conv->status() != VELODT_OK) {
+        reply[0] = conv->status();
+        n = 0;
+      } else {
+        reply[1] = conv->outputs();
+        out.resize(reply[1]*static_cast<int>(n));
+        reply[0] = conv->convert(n, in.constData(), in.constData() + n,
+                                 out.data(), out.data() + (reply[1] - 1)*n);
+      }
+      delete own;
+    }
+    if (!sendAll(fd, reply, sizeof(reply)) || !sendAll(fd, &n, sizeof(n))
+        || !sendAll(fd, out.constData(), reply[1]*n*sizeof(double)))
+      return false;
+  }
+}
+
+void Server::run(int &argc, char *argv[]) {
+  readArgs(argc, argv);
+
+  // Replace a socket left by a previous server, but never another file
+  QByteArray path = Socket.toUtf8();
+  struct stat info;
+  if (path.size() >= static_cast<int>(sizeof(SocketPath))) {
+    cout << PRINT_ERROR "Socket path too long: " << path.data() << endl;
+    exit(1);
+  }
+  if (stat(path.data(), &info) == 0) {
+    if (!S_ISSOCK(info.st_mode)) {
+      cout << PRINT_ERROR << path.data() << " exists and is no socket"
+           << endl;
+      exit(1);
+    }
+    unlink(path.data());
+  }
+  strcpy(SocketPath, path.data());
+
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, SocketPath);
+  Listen = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (Listen < 0
+      || bind(Listen, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0
+      || listen(Listen, 64) != 0) {
+    cout << PRINT_ERROR "Can not listen on " << SocketPath << ": "
+         << strerror(errno) << endl;
+    exit(1);
+  }
+  signal(SIGINT, stop);
+  signal(SIGTERM, stop);
+
+  // Set up the shared tables before the first request
+  Converter::referenceModel(VELODT_AK135);
+  Converter::referenceModel(VELODT_PREM);
+  RockModel::table();
+
+  cout << "Serving on " << SocketPath << " with " << threads()
+       << " threads" << endl;
+#ifdef _OPENMP
+  #pragma omp parallel num_threads(threads())
+#endif
+  {
+    while (true) {
+      int fd = accept(Listen, 0, 0);
+      if (fd < 0) {
+        if (errno == EINTR || errno == ECONNABORTED)
+          continue;
+        break;
+      }
+      serve(fd);
+      close(fd);
+    }
+  }
+  unlink(SocketPath);
+}
@@ -0,0 +1,30 @@
+/*******************************************************************************
+*                     Copyright (C) 2020 by Christian Meeßen                   *
+*                                                                              *
+*                          This file is part of VeloDT.                        *
+*                                                                              *
+*         VeloDT is free software: you can redistribute it and/or modify       *
+*     it under the terms of the GNU General Public License as published by     *
+*           the Free Software Foundation version 3 of the License.             *
+*                                                                              *
+*        VeloDT is distributed in the hope that it will be useful, but         *
+*          WITHOUT ANY WARRANTY; without even the implied warranty of          *
+*       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       *
+*                   General Public License for more details.                   *
+*                                                                              *
+*      You should have received a copy of the GNU General Public License       *
+*        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************/
+#include <string.h>
+#include "Pipeline.h"
+#include "Server.h"
+
+int main(int argc, char *argv[]) {
+  if (argc > 1 && strcmp(argv[1], "serve") == 0) {
+    Server Daemon;
+    Daemon.run(argc, argv);
+  } else {
+    Pipeline Chain;
+    Chain.run(argc, argv);
+  }
+}
@@ -0,0 +1,47 @@
+################################################################################
+#                     Copyright (C) 2020 by Christian Meeßen                   #
+#                                                                              #
+#                          This file is part of VeloDT.                        #
+#                                                                              #
+#         VeloDT is free software: you can redistribute it and/or modify       #
+#     it under the terms of the GNU General Public License as published by     #
+#           the Free Software Foundation version 3 of the License.             #
+#                                                                              #
+#        VeloDT is distributed in the hope that it will be useful, but         #
+#          WITHOUT ANY WARRANTY; without even the implied warranty of          #
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU       #
+#                   General Public License for more details.                   #
+#                                                                              #
+#      You should have received a copy of the GNU General Public License       #
+#        along with VeloDT. If not, see <http://www.gnu.org/licenses/>.        #
+################################################################################
+TEMPLATE = app
+DESTDIR = ../../bin
+TARGET = velodt
+CONFIG -= app_bundle
+CONFIG += c++11
+
+INCLUDEPATH += ../../include/common ../../include/velodt \
+               ../../include/V2T ../../include/T2Rho ../../include/V2RhoT \
+               ../../include/libvelodt
+
+LIBS += -L../common -lcommon
+netcdf {
+  LIBS += -lnetcdf
+}
+# OpenMP parallelises the conversion, disable with 'qmake CONFIG+=no_openmp'
+!no_openmp {
+  QMAKE_CXXFLAGS += -fopenmp
+  QMAKE_LFLAGS += -fopenmp
+}
+
+SOURCES += main.cpp Pipeline.cpp Server.cpp \
+           ../libvelodt/libvelodt.cpp ../libvelodt/Converters.cpp \
+           ../V2T/V2T.cpp ../V2T/TemperatureSolver.cpp \
+           ../T2Rho/T2Rho.cpp ../T2Rho/DensityKernel.cpp \
+           ../V2RhoT/V2RhoT.cpp ../V2RhoT/Rock.cpp \
+           ../V2RhoT/RockModel.cpp ../V2RhoT/MineraldRhodT.cpp \
+           ../V2RhoT/RockEnsemble.cpp ../V2RhoT/JointInversion.cpp
+
+HEADERS += ../../include/velodt/Pipeline.h \
+           ../../include/velodt/Server.h